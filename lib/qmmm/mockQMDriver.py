@@ -0,0 +1,99 @@
+#!/usr/bin/python3
+
+# Mock driver for NAMD's persistent QM interface ("QMPersistent on" together
+# with "QMSoftware custom"). It is meant for testing the protocol and as a
+# starting point for real drivers, not for producing meaningful QM forces.
+#
+# NAMD starts this script once per QM group, inside the group's directory
+# under QMBaseDir, with the QM group index as its only argument. Requests
+# arrive on standard input and replies are written to standard output, so
+# any logging must go to standard error. The binary format (native byte
+# order) is documented in src/ComputeQM.C:
+#
+# Request:  int32 magic, version, command, timestep, group, numAtoms,
+#           numPntChrgs, chargeMode
+#           char[4] element           x numAtoms
+#           double x, y, z            x numAtoms
+#           double x, y, z, charge    x numPntChrgs
+#
+# Reply:    int32 magic, status, numPCForces, reserved
+#           double energy
+#           double fx, fy, fz, charge x numAtoms
+#           double fx, fy, fz         x numPCForces
+#
+# The "QM" model is a harmonic well of force constant K around the positions
+# seen in the first request, with zero charges on all atoms. Keeping the
+# reference positions between requests stands in for what a real driver
+# would keep across steps, such as the previous wavefunction.
+
+import struct
+from sys import argv as sargv
+from sys import stdin, stdout, stderr
+
+MAGIC = 0x444d514e
+VERSION = 1
+CMD_CALC = 1
+CMD_EXIT = 2
+
+# kcal/mol/A^2
+K = 10.0
+
+header = struct.Struct("=8i")
+reply = struct.Struct("=4id")
+
+inp = stdin.buffer
+out = stdout.buffer
+
+def readAll(n):
+    data = b""
+    while len(data) < n:
+        chunk = inp.read(n - len(data))
+        if not chunk:
+            return None
+        data += chunk
+    return data
+
+group = sargv[1] if len(sargv) > 1 else "?"
+refPos = None
+
+while True:
+
+    data = readAll(header.size)
+    if data is None:
+        break
+
+    magic, version, command, step, grp, numAtoms, numPC, chrgMode = header.unpack(data)
+
+    if magic != MAGIC or version != VERSION:
+        stderr.write("mockQMDriver: bad request header\n")
+        break
+
+    if command == CMD_EXIT:
+        break
+
+    elements = readAll(4*numAtoms)
+    pos = struct.unpack("=%dd" % (3*numAtoms), readAll(8*3*numAtoms))
+    pc = struct.unpack("=%dd" % (4*numPC), readAll(8*4*numPC))
+
+    if refPos is None or len(refPos) != len(pos):
+        refPos = pos
+
+    energy = 0.0
+    forces = []
+    for i in range(3*numAtoms):
+        d = pos[i] - refPos[i]
+        energy += 0.5*K*d*d
+        forces.append(-K*d)
+
+    res = []
+    for i in range(numAtoms):
+        res.extend(forces[3*i:3*i+3])
+        res.append(0.0)
+
+    out.write(reply.pack(MAGIC, 0, 0, 0, energy))
+    out.write(struct.pack("=%dd" % (4*numAtoms), *res))
+    out.flush()
+
+    stderr.write("mockQMDriver: group %s step %d: %d atoms, %d point charges, E = %f\n"
+                 % (group, step, numAtoms, numPC, energy))
+
@@ -25,6 +25,35 @@
 #include "pdb_file.h"
 #include "psfgen.h"
 
+/* Write the first n of id1..id4 as " %7d" (" %9d" for EXT format).
+ * The bond, angle, dihedral, improper and exclusion lists are most of
+ * a large psf file and are formatted here rather than with fprintf.
+ */
+static void write_psf_ids(FILE *file, int charmmext, int n,
+                          int id1, int id2, int id3, int id4) {
+  char buf[4*12], digits[12];
+  char *p = buf;
+  int ids[4];
+  int i, nd, pad, width;
+  unsigned int u;
+
+  ids[0] = id1;  ids[1] = id2;  ids[2] = id3;  ids[3] = id4;
+  width = charmmext ? 9 : 7;
+  for ( i = 0; i < n; ++i ) {
+    u = ( ids[i] < 0 ) ? 0u - (unsigned int) ids[i] : (unsigned int) ids[i];
+    nd = 0;
+    do {
+      digits[nd++] = '0' + u % 10;
+      u /= 10;
+    } while ( u );
+    if ( ids[i] < 0 ) digits[nd++] = '-';
+    *(p++) = ' ';
+    for ( pad = width - nd; pad > 0; --pad ) *(p++) = ' ';
+    while ( nd ) *(p++) = digits[--nd];
+  }
+  fwrite(buf, 1, p - buf, file);
+}
+
 int topo_mol_write_pdb(topo_mol *mol, FILE *file, void *vdata, void *v, 
                                 void (*print_msg)(void *, void *, const char *)) {
 
@@ -860,8 +889,8 @@ int topo_mol_write_psf(topo_mol *mol, FILE *file, int charmmfmt, int nocmap,
             
 #if !defined(NOIO)
           if ( numinline == 4 ) { fprintf(file,"\n");  numinline = 0; }
-          fprintf(file, ( charmmext ? " %9d %9d" : " %7d %7d"),
-                  atom->atomid,atom->lonepair->atoms[1]->atomid);
+          write_psf_ids(file,charmmext,2,
+                  atom->atomid,atom->lonepair->atoms[1]->atomid,0,0);
 #endif
           ++numinline;
           continue;
@@ -880,8 +909,8 @@ int topo_mol_write_psf(topo_mol *mol, FILE *file, int charmmfmt, int nocmap,
             
 #if !defined(NOIO)
             if ( numinline == 4 ) { fprintf(file,"\n");  numinline = 0; }
-            fprintf(file, ( charmmext ? " %9d %9d" : " %7d %7d"),
-                    atom->atomid,bond->atom[1]->atomid);
+            write_psf_ids(file,charmmext,2,
+                    atom->atomid,bond->atom[1]->atomid,0,0);
 #endif
             ++numinline;
           }
@@ -890,8 +919,8 @@ int topo_mol_write_psf(topo_mol *mol, FILE *file, int charmmfmt, int nocmap,
           if ( bond->atom[0]->atomid == atom->atomid && ! bond->del ) {
               
             if ( numinline == 4 ) { fprintf(file,"\n");  numinline = 0; }
-            fprintf(file, ( charmmext ? " %9d %9d" : " %7d %7d"),
-                    atom->atomid,bond->atom[1]->atomid);
+            write_psf_ids(file,charmmext,2,
+                    atom->atomid,bond->atom[1]->atomid,0,0);
             ++numinline;
             
           }
@@ -902,8 +931,8 @@ int topo_mol_write_psf(topo_mol *mol, FILE *file, int charmmfmt, int nocmap,
         if (psfcontext->VPBONDS && atom->alpha) {
 #if !defined(NOIO)
           if ( numinline == 4 ) { fprintf(file,"\n");  numinline = 0; }
-          fprintf(file, ( charmmext ? " %9d %9d" : " %7d %7d"),
-                  atom->atomid,atom->atomid +1);
+          write_psf_ids(file,charmmext,2,
+                  atom->atomid,atom->atomid +1,0,0);
 #endif
           ++numinline;
         }
@@ -936,8 +965,8 @@ int topo_mol_write_psf(topo_mol *mol, FILE *file, int charmmfmt, int nocmap,
 
 #if !defined(NOIO)
             if ( numinline == 3 ) { fprintf(file,"\n");  numinline = 0; }
-            fprintf(file, ( charmmext ? " %9d %9d %9d" : " %7d %7d %7d"),atom->atomid,
-                angl->atom[1]->atomid,angl->atom[2]->atomid);
+            write_psf_ids(file,charmmext,3,atom->atomid,
+                angl->atom[1]->atomid,angl->atom[2]->atomid,0);
 #endif
 
             ++numinline;
@@ -955,8 +984,8 @@ int topo_mol_write_psf(topo_mol *mol, FILE *file, int charmmfmt, int nocmap,
               angl->atom[2]->isdrudlonepair) continue;
 #if !defined(NOIO)
           if ( numinline == 3 ) { fprintf(file,"\n");  numinline = 0; }
-          fprintf(file, ( charmmext ? " %9d %9d %9d" : " %7d %7d %7d"),atom->atomid,
-              angl->atom[1]->atomid,angl->atom[2]->atomid);
+          write_psf_ids(file,charmmext,3,atom->atomid,
+              angl->atom[1]->atomid,angl->atom[2]->atomid,0);
 #endif
           ++numinline;
         }
@@ -989,7 +1018,7 @@ int topo_mol_write_psf(topo_mol *mol, FILE *file, int charmmfmt, int nocmap,
 
 #if !defined(NOIO)
             if ( numinline == 2 ) { fprintf(file,"\n");  numinline = 0; }
-            fprintf(file, ( charmmext ? " %9d %9d %9d %9d" : " %7d %7d %7d %7d"),atom->atomid,
+            write_psf_ids(file,charmmext,4,atom->atomid,
                 dihe->atom[1]->atomid,dihe->atom[2]->atomid,
                 dihe->atom[3]->atomid);
 #endif
@@ -1010,7 +1039,7 @@ int topo_mol_write_psf(topo_mol *mol, FILE *file, int charmmfmt, int nocmap,
             continue;
 #if !defined(NOIO)
           if ( numinline == 2 ) { fprintf(file,"\n");  numinline = 0; }
-          fprintf(file, ( charmmext ? " %9d %9d %9d %9d" : " %7d %7d %7d %7d"),atom->atomid,
+          write_psf_ids(file,charmmext,4,atom->atomid,
               dihe->atom[0]->atomid,dihe->atom[1]->atomid,
               dihe->atom[2]->atomid);
 #endif
@@ -1044,7 +1073,7 @@ int topo_mol_write_psf(topo_mol *mol, FILE *file, int charmmfmt, int nocmap,
           if ( impr->atom[0] == atom && ! impr->del ) {
 #if !defined(NOIO)
             if ( numinline == 2 ) { fprintf(file,"\n");  numinline = 0; }
-            fprintf(file, ( charmmext ? " %9d %9d %9d %9d" : " %7d %7d %7d %7d"),atom->atomid,
+            write_psf_ids(file,charmmext,4,atom->atomid,
                 impr->atom[1]->atomid,impr->atom[2]->atomid,
                 impr->atom[3]->atomid);
 #endif
@@ -1064,7 +1093,7 @@ int topo_mol_write_psf(topo_mol *mol, FILE *file, int charmmfmt, int nocmap,
             continue;
 #if !defined(NOIO)
             if ( numinline == 2 ) { fprintf(file,"\n");  numinline = 0; }
-            fprintf(file, ( charmmext ? " %9d %9d %9d %9d" : " %7d %7d %7d %7d"),atom->atomid,
+            write_psf_ids(file,charmmext,4,atom->atomid,
                 impr->atom[0]->atomid,impr->atom[1]->atomid,
                 impr->atom[2]->atomid);
 #endif
@@ -1110,7 +1139,7 @@ int topo_mol_write_psf(topo_mol *mol, FILE *file, int charmmfmt, int nocmap,
 
 #if !defined(NOIO)
               if ( numinline == 8 ) { fprintf(file,"\n");  numinline = 0; }
-              fprintf(file,(charmmext?" %9d":" %7d"),excl->atom[1]->atomid);
+              write_psf_ids(file,charmmext,1,excl->atom[1]->atomid,0,0,0);
 #endif
 
               ++numinline;
@@ -1159,7 +1188,7 @@ int topo_mol_write_psf(topo_mol *mol, FILE *file, int charmmfmt, int nocmap,
         
 #if !defined(NOIO)
           if ( numinline == 8 ) { fprintf(file,"\n");  numinline = 0; }
-          fprintf(file,(charmmext?" %9d":" %7d"),nexcls);
+          write_psf_ids(file,charmmext,1,nexcls,0,0,0);
 #endif
 
 
@@ -1299,8 +1328,8 @@ int topo_mol_write_psf(topo_mol *mol, FILE *file, int charmmfmt, int nocmap,
             for (j = 0 ; j < numlphosts; j++) {
               
 #if !defined(NOIO)
-              fprintf(file, ( charmmext ? " %9d" : " %7d"),
-              atom->lonepair->atoms[j]->atomid);
+              write_psf_ids(file,charmmext,1,
+              atom->lonepair->atoms[j]->atomid,0,0,0);
 #endif
 
               ++numinline;
@@ -1348,7 +1377,7 @@ int topo_mol_write_psf(topo_mol *mol, FILE *file, int charmmfmt, int nocmap,
           for ( aniso = res->aniso; aniso; aniso = aniso->next ) { 
             if (aniso->del) continue;
 #if !defined(NOIO)
-            fprintf(file, ( charmmext ? " %9d %9d %9d %9d" : " %7d %7d %7d %7d"),
+            write_psf_ids(file,charmmext,4,
             aniso->atoms[0]->atomid,  aniso->atoms[1]->atomid, 
             aniso->atoms[2]->atomid, aniso->atoms[3]->atomid);
 #endif
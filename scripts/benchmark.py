@@ -0,0 +1,333 @@
+import os
+import csv
+import math
+import random
+import argparse
+import subprocess
+from datetime import datetime
+
+# Strong-scaling benchmark on the local machine with generated inputs.
+#
+# For every requested system size a water box (optionally with Na+/Cl-
+# ions and bead chains with bonds, angles and dihedrals) is written as
+# PSF/PDB/parameter files, NAMD is run for a fixed number of steps at each
+# PE count, and the [MO833] lines of the output are summarized into a CSV
+# with the columns of experimental_results.summary.csv followed by the
+# initialization time, per-step percentiles and parallel efficiency.
+
+header = ['test-case', 'cfg', 'data', 'total_time-time', 'total_time-main', 'beta', 'avg-PIs', 'n-PIs', '1st-PI', '2nd-PI', 'avg(2-6)', 'avg(2-11)',
+          'init-time', 'p50-PI', 'p90-PI', 'p99-PI', 'speedup', 'efficiency']
+
+# TIP3P geometry
+WATER_SPACING = 3.104    # lattice spacing giving the density of liquid water
+OH_BOND = 0.9572
+HOH_ANGLE = 104.52
+
+PARAMETERS = '''* Parameters for the synthetic benchmark systems
+*
+
+BONDS
+OT   HT     450.000     0.9572
+HT   HT       0.000     1.5139
+CB   CB     100.000     %.4f
+
+ANGLES
+HT   OT   HT      55.000   104.5200
+CB   CB   CB       5.000   135.0000
+
+DIHEDRALS
+CB   CB   CB   CB      0.2000  3     0.00
+
+IMPROPER
+
+NONBONDED nbxmod  5 atom cdiel shift vatom vdistance vswitch -
+cutnb 14.0 ctofnb 12.0 ctonnb 10.0 eps 1.0 e14fac 1.0 wmin 1.5
+
+OT     0.000000  -0.152100     1.768200
+HT     0.000000  -0.046000     0.224500
+SOD    0.000000  -0.046900     1.410750
+CLA    0.000000  -0.150000     2.270000
+CB     0.000000  -0.110000     2.000000
+
+END
+''' % WATER_SPACING
+
+CONFIG = '''structure          system.psf
+coordinates        system.pdb
+paraTypeCharmm     on
+parameters         system.prm
+
+temperature        300
+seed               %(seed)d
+
+exclude            scaled1-4
+1-4scaling         1.0
+cutoff             12.0
+switching          on
+switchdist         10.0
+pairlistdist       13.5
+margin             2.5
+
+timestep           2.0
+rigidBonds         water
+nonbondedFreq      1
+fullElectFrequency 2
+stepspercycle      20
+
+cellBasisVector1   %(edge)f 0 0
+cellBasisVector2   0 %(edge)f 0
+cellBasisVector3   0 0 %(edge)f
+cellOrigin         0 0 0
+wrapAll            on
+
+PME                yes
+PMEGridSpacing     1.0
+
+outputName         output
+outputEnergies     %(steps)d
+outputTiming       %(steps)d
+restartfreq        0
+dcdfreq            0
+
+numsteps           %(steps)d
+'''
+
+def snake_sites(n):
+    # lattice sites in an order where consecutive sites are neighbors
+    sites = []
+    for k in range(n):
+        rows = range(n) if k % 2 == 0 else range(n-1, -1, -1)
+        for jj, j in enumerate(rows):
+            cols = range(n) if (k*n + jj) % 2 == 0 else range(n-1, -1, -1)
+            for i in cols:
+                sites.append((i, j, k))
+    return sites
+
+def generate(path, atoms, ion_conc, chains, chain_length, seed):
+    # Returns the number of atoms and the box edge of the generated system.
+    rng = random.Random(seed)
+    n = max(2, int(math.ceil((atoms / 3.0) ** (1.0/3.0))))
+    edge = n * WATER_SPACING
+    sites = snake_sites(n)
+
+    kind = ['W'] * len(sites)
+    if chains * chain_length > len(sites) // 2:
+        raise SystemExit('chains do not fit in a box of %d water sites' % len(sites))
+    stride = len(sites) // max(chains, 1)
+    chain_sites = []
+    for c in range(chains):
+        first = c * stride
+        chain_sites.append(range(first, first + chain_length))
+        for s in range(first, first + chain_length):
+            kind[s] = 'B'
+
+    pairs = int(round(ion_conc * edge**3 * 6.022e-4))
+    waters = [s for s in range(len(sites)) if kind[s] == 'W']
+    if 2 * pairs > len(waters) // 2:
+        raise SystemExit('ion concentration too high for the box')
+    for m, s in enumerate(rng.sample(waters, 2 * pairs)):
+        kind[s] = 'SOD' if m % 2 == 0 else 'CLA'
+
+    half = math.radians(HOH_ANGLE / 2.0)
+    hx = OH_BOND * math.cos(half)
+    hy = OH_BOND * math.sin(half)
+
+    # atom records: segname, resid, resname, name, type, charge, mass, x, y, z
+    atom_list = []
+    bonds = []
+    angles = []
+    dihedrals = []
+    segcount = {}
+
+    def next_resid(prefix):
+        # resids stay within the four PDB columns by starting new segments
+        count = segcount.get(prefix, 0)
+        segcount[prefix] = count + 1
+        return '%s%03d' % (prefix, count // 9999 + 1), count % 9999 + 1
+
+    for c, sites_c in enumerate(chain_sites):
+        segname = 'P%03d' % (c + 1)
+        first = len(atom_list)
+        for r, s in enumerate(sites_c):
+            i, j, k = sites[s]
+            atom_list.append((segname, r + 1, 'BEA', 'CB', 'CB', 0.0, 12.011,
+                              i*WATER_SPACING, j*WATER_SPACING, k*WATER_SPACING))
+        for b in range(first, len(atom_list) - 1):
+            bonds.append((b, b+1))
+        for b in range(first, len(atom_list) - 2):
+            angles.append((b, b+1, b+2))
+        for b in range(first, len(atom_list) - 3):
+            dihedrals.append((b, b+1, b+2, b+3))
+
+    for s, (i, j, k) in enumerate(sites):
+        x, y, z = i*WATER_SPACING, j*WATER_SPACING, k*WATER_SPACING
+        if kind[s] == 'W':
+            segname, resid = next_resid('W')
+            # alternate orientation so the box has no net dipole
+            d = 1.0 if (i + j + k) % 2 == 0 else -1.0
+            o = len(atom_list)
+            atom_list.append((segname, resid, 'TIP3', 'OH2', 'OT', -0.834, 15.9994, x, y, z))
+            atom_list.append((segname, resid, 'TIP3', 'H1', 'HT', 0.417, 1.008, x + d*hx, y + hy, z))
+            atom_list.append((segname, resid, 'TIP3', 'H2', 'HT', 0.417, 1.008, x + d*hx, y - hy, z))
+            bonds.extend([(o, o+1), (o, o+2), (o+1, o+2)])
+            angles.append((o+1, o, o+2))
+        elif kind[s] in ('SOD', 'CLA'):
+            segname, resid = next_resid('I')
+            charge, mass = (1.0, 22.98977) if kind[s] == 'SOD' else (-1.0, 35.45)
+            atom_list.append((segname, resid, kind[s], kind[s], kind[s], charge, mass, x, y, z))
+
+    with open(os.path.join(path, 'system.prm'), 'w') as f:
+        f.write(PARAMETERS)
+
+    with open(os.path.join(path, 'system.pdb'), 'w') as f:
+        f.write('REMARK synthetic benchmark system\n')
+        f.write('CRYST1%9.3f%9.3f%9.3f  90.00  90.00  90.00 P 1           1\n' % (edge, edge, edge))
+        for a, (seg, resid, resname, name, atype, charge, mass, x, y, z) in enumerate(atom_list):
+            f.write('ATOM  %5d %-4s %-4s %4d    %8.3f%8.3f%8.3f  1.00  0.00      %-4s\n'
+                    % ((a + 1) % 100000, name if len(name) == 4 else ' ' + name, resname, resid, x, y, z, seg))
+        f.write('END\n')
+
+    def section(f, items, per_line, title):
+        f.write('\n%8d !%s\n' % (len(items), title))
+        for m in range(0, len(items), per_line):
+            f.write(''.join('%8d' % (a + 1) for item in items[m:m+per_line] for a in item))
+            f.write('\n')
+
+    with open(os.path.join(path, 'system.psf'), 'w') as f:
+        f.write('PSF\n\n%8d !NTITLE\n REMARKS synthetic benchmark system\n\n' % 1)
+        f.write('%8d !NATOM\n' % len(atom_list))
+        for a, (seg, resid, resname, name, atype, charge, mass, x, y, z) in enumerate(atom_list):
+            f.write('%8d %-4s %-4d %-4s %-4s %-4s %10.6f %13.4f %11d\n'
+                    % (a + 1, seg, resid, resname, name, atype, charge, mass, 0))
+        section(f, bonds, 4, 'NBOND: bonds')
+        section(f, angles, 3, 'NTHETA: angles')
+        section(f, dihedrals, 2, 'NPHI: dihedrals')
+        section(f, [], 2, 'NIMPHI: impropers')
+        section(f, [], 4, 'NDON: donors')
+        section(f, [], 4, 'NACC: acceptors')
+        section(f, [], 8, 'NNB')
+        f.write('\n')
+
+    return len(atom_list), edge
+
+def summary(path, wall):
+    # Same quantities as summary.py, read from the [MO833] lines of namd.out.
+    pis = {}
+    total_main = beta = pi_avg = n_pi = '-'
+    ends = {}
+    for line in open(os.path.join(path, 'namd.out')):
+        if not line.startswith('[MO833]'):
+            continue
+        f = line.strip().split(',')
+        if f[0] == '[MO833] Paramount Iteration':
+            step = int(f[2])
+            pis[step] = float(f[3])
+            ends[step] = float(f[4])
+        elif f[0] == '[MO833] Total time':
+            total_main = f[1]
+        elif f[0] == '[MO833] Beta':
+            beta = f[2]
+        elif f[0] == '[MO833] PI avg':
+            pi_avg, n_pi = f[2], f[3]
+
+    if not pis:
+        return None
+
+    steps = sorted(pis)
+    times = [pis[s] for s in steps]
+    # start of the first step relative to the start of main
+    init = round(ends[steps[0]] - times[0], 6)
+    ordered = sorted(times)
+
+    def percentile(p):
+        return round(ordered[min(len(ordered) - 1, int(math.ceil(p / 100.0 * len(ordered))) - 1)], 6)
+
+    def average(first, last):
+        window = [pis[s] for s in range(steps[0] + first - 1, steps[0] + last) if s in pis]
+        return round(sum(window) / len(window), 6) if len(window) == last - first + 1 else 0
+
+    return [round(wall, 2), total_main, beta, pi_avg, n_pi,
+            times[0], times[1] if len(times) > 1 else '-', average(2, 6), average(2, 11),
+            init, percentile(50), percentile(90), percentile(99)]
+
+def run(args, path, pes):
+    command = []
+    if args.charmrun:
+        command = [args.charmrun, '+p%d' % pes] + args.charmrun_args.split() + [args.namd]
+    else:
+        command = [args.namd, '+p%d' % pes]
+    command += args.namd_args.split() + ['system.namd']
+    with open(os.path.join(path, 'namd.out'), 'w') as out, open(os.path.join(path, 'namd.err'), 'w') as err:
+        start = datetime.now()
+        status = subprocess.call(command, cwd=path, stdout=out, stderr=err)
+        wall = (datetime.now() - start).total_seconds()
+    if status != 0:
+        print('NAMD exited with status %d, see %s' % (status, path))
+    return wall
+
+def main(args):
+    sizes = [int(s) for s in args.atoms.split(',')]
+    pe_counts = [int(p) for p in args.pes.split(',')]
+    os.makedirs(args.work_dir, exist_ok=True)
+
+    rows = [header]
+    for size in sizes:
+        case_dir = os.path.join(args.work_dir, 'synthetic-%d' % size)
+        os.makedirs(case_dir, exist_ok=True)
+        natoms, edge = generate(case_dir, size, args.ions, args.chains, args.chain_length, args.seed)
+        test_case = 'synthetic-%d' % natoms
+        print('%s: %d atoms in a %.1f A box' % (test_case, natoms, edge))
+
+        # reference for speedup and efficiency is the smallest PE count
+        reference = {}
+        for repeat in range(args.repeats):
+            for pes in sorted(pe_counts):
+                cfg = 'local-%dpe' % pes
+                date = datetime.now().strftime('%d-%m-%Y-%H-%M-%S')
+                path = os.path.join(case_dir, cfg, date)
+                os.makedirs(path, exist_ok=True)
+                for name in ('system.psf', 'system.pdb', 'system.prm'):
+                    target = os.path.join(path, name)
+                    if not os.path.exists(target):
+                        os.symlink(os.path.abspath(os.path.join(case_dir, name)), target)
+                with open(os.path.join(path, 'system.namd'), 'w') as f:
+                    f.write(CONFIG % {'seed': args.seed, 'edge': edge, 'steps': args.steps})
+
+                print('Running %s on %d PEs' % (test_case, pes))
+                wall = run(args, path, pes)
+                data = summary(path, wall)
+                if data is None:
+                    continue
+
+                avg = float(data[3]) if data[3] != '-' else data[10]
+                if not reference:
+                    reference = {'pes': pes, 'avg': avg}
+                speedup = reference['avg'] / avg
+                efficiency = speedup * reference['pes'] / pes
+                rows.append([test_case, cfg, date] + data +
+                            [round(speedup, 4), round(efficiency, 4)])
+
+    with open(args.output, 'w') as file:
+        writer = csv.writer(file, delimiter=',')
+        writer.writerows(rows)
+    print('Wrote %s' % args.output)
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description='Local strong-scaling benchmark with synthetic systems')
+    parser.add_argument('--namd', dest='namd', type=str, default='namd2', help='NAMD binary')
+    parser.add_argument('--namd-args', dest='namd_args', type=str, default='', help='extra NAMD arguments, e.g. "-max-pi 100"')
+    parser.add_argument('--charmrun', dest='charmrun', type=str, default='', help='charmrun for non-multicore builds')
+    parser.add_argument('--charmrun-args', dest='charmrun_args', type=str, default='', help='extra charmrun arguments')
+    parser.add_argument('--atoms', dest='atoms', type=str, default='24000', help='comma separated approximate system sizes')
+    parser.add_argument('--pes', dest='pes', type=str, default='1,2,4', help='comma separated PE counts')
+    parser.add_argument('--steps', dest='steps', type=int, default=500, help='steps per run')
+    parser.add_argument('--repeats', dest='repeats', type=int, default=1, help='runs per size and PE count')
+    parser.add_argument('--ions', dest='ions', type=float, default=0.0, help='NaCl concentration in mol/L')
+    parser.add_argument('--chains', dest='chains', type=int, default=0, help='number of bonded bead chains')
+    parser.add_argument('--chain-length', dest='chain_length', type=int, default=100, help='beads per chain')
+    parser.add_argument('--seed', dest='seed', type=int, default=1234, help='random seed')
+    parser.add_argument('-d', dest='work_dir', type=str, default='benchmark', help='directory for inputs and outputs')
+    parser.add_argument('-o', dest='output', type=str, default='benchmark.summary.csv', help='CSV file to write')
+    args = parser.parse_args()
+
+    main(args)
@@ -0,0 +1,330 @@
+import os
+import re
+import math
+import argparse
+import subprocess
+
+# Accuracy-constrained tuning of cutoff, PME grid, interpolation order and
+# fullElectFrequency for a NAMD configuration.
+#
+# The RMS force errors of the real-space and reciprocal Ewald sums are
+# estimated for every candidate with the formulas of Kolafa and Perram
+# (real space) and Deserno and Holm as used by LAMMPS (reciprocal space).
+# For each cutoff and order only the coarsest grid meeting the tolerance
+# is kept, each remaining candidate is run for a few steps on the
+# requested PEs, and the base configuration is written out again with
+# the parameters of the fastest candidate.
+#
+# NAMD fixes the patch grid and the PME decomposition at startup, so the
+# candidates are separate short runs rather than phases of one run.
+#
+# The estimates do not include the error of multiple time stepping, so by
+# default fullElectFrequency is not raised above that of the base
+# configuration.  Larger values are only tried with --allow-larger-fullelect
+# and are marked as outside the error estimate.
+
+COULOMB = 332.0636
+
+# coefficients of the reciprocal error estimate, indexed by order
+ACONS = {
+    4: [1.0/4320.0, 3.0/1936.0, 7601.0/2271360.0, 143.0/28800.0],
+    5: [1.0/23232.0, 7601.0/13628160.0, 143.0/69120.0, 517231.0/106536960.0, 106640677.0/11737571328.0],
+    6: [691.0/68140800.0, 13.0/57600.0, 47021.0/35512320.0, 9694607.0/2095994880.0,
+        733191589.0/59609088000.0, 326190917.0/11700633600.0],
+    7: [1.0/345600.0, 3617.0/35512320.0, 745739.0/838397952.0, 56399353.0/12773376000.0,
+        25091609.0/1560084480.0, 1755948832039.0/36229939200000.0, 4887769399.0/37838389248.0],
+}
+
+TUNED = ('cutoff', 'switchdist', 'pairlistdist', 'pmegridspacing', 'pmegridsizex',
+         'pmegridsizey', 'pmegridsizez', 'pmeinterporder', 'fullelectfrequency')
+
+def read_config(path):
+    # keyword/value pairs of a plain NAMD config, keywords in lower case
+    options = {}
+    lines = []
+    for line in open(path):
+        lines.append(line)
+        text = line.split('#')[0].strip()
+        if not text:
+            continue
+        words = text.split(None, 1)
+        key = words[0].lower()
+        value = words[1].strip() if len(words) > 1 else ''
+        if key == 'set':
+            continue
+        options[key] = value
+    return options, lines
+
+def read_charges(psf):
+    # number of atoms and sum of squared charges from the NATOM section
+    with open(psf) as f:
+        for line in f:
+            if '!NATOM' in line:
+                natoms = int(line.split()[0])
+                break
+        else:
+            raise SystemExit('no !NATOM section in %s' % psf)
+        q2 = 0.0
+        for i in range(natoms):
+            q = float(f.readline().split()[6])
+            q2 += q*q
+    return natoms, q2
+
+def read_cell(options, base_dir):
+    # lengths of the cell basis vectors and the cell volume
+    vectors = []
+    if 'extendedsystem' in options:
+        last = None
+        for line in open(os.path.join(base_dir, options['extendedsystem'])):
+            if line.strip() and not line.startswith('#'):
+                last = line.split()
+        v = [float(x) for x in last[1:10]]
+        vectors = [v[0:3], v[3:6], v[6:9]]
+    else:
+        for k in ('cellbasisvector1', 'cellbasisvector2', 'cellbasisvector3'):
+            if k not in options:
+                raise SystemExit('PME needs a periodic cell, %s is missing' % k)
+            vectors.append([float(x) for x in options[k].split()])
+    a, b, c = vectors
+    cross = [b[1]*c[2] - b[2]*c[1], b[2]*c[0] - b[0]*c[2], b[0]*c[1] - b[1]*c[0]]
+    volume = abs(sum(a[i]*cross[i] for i in range(3)))
+    return [math.sqrt(sum(x*x for x in v)) for v in vectors], volume
+
+def ewald_coefficient(cutoff, tolerance):
+    # as in SimParameters::check_config
+    hi = 1.0
+    while math.erfc(hi*cutoff)/cutoff >= tolerance:
+        hi *= 2.0
+    lo = 0.0
+    for i in range(100):
+        mid = 0.5*(lo + hi)
+        if math.erfc(mid*cutoff)/cutoff >= tolerance:
+            lo = mid
+        else:
+            hi = mid
+    return 0.5*(lo + hi)
+
+def grid_size(length, spacing):
+    # smallest even size with small prime factors, as in SimParameters
+    min_size = int(math.ceil(length/spacing))
+    best = 10*(min_size + 10)
+    max2 = max3 = 2
+    ts = 1
+    while ts < min_size:
+        ts *= 2
+        max2 += 1
+    ts = 1
+    while ts < min_size:
+        ts *= 3
+        max3 += 1
+    for i2 in range(max2 + 1):
+        for i3 in range(max3 + 1):
+            for i5 in range(3):
+                for i7 in range(2):
+                    for i11 in range(2):
+                        if i5 + i7 + i11 > i2:
+                            continue
+                        size = 2 * 2**i2 * 3**i3 * 5**i5 * 7**i7 * 11**i11
+                        if min_size <= size < best:
+                            best = size
+    return best
+
+def real_error(q2, natoms, volume, cutoff, beta):
+    return 2.0*COULOMB*q2*math.exp(-beta*beta*cutoff*cutoff)/math.sqrt(natoms*cutoff*volume)
+
+def recip_error(q2, natoms, lengths, sizes, order, beta):
+    acons = ACONS[order]
+    total = 0.0
+    for length, size in zip(lengths, sizes):
+        hb = beta*length/size
+        s = sum(a*hb**(2*m) for m, a in enumerate(acons))
+        e = COULOMB*q2*hb**order*math.sqrt(beta*length*math.sqrt(2.0*math.pi)*s/natoms)/(length*length)
+        total += e*e
+    return math.sqrt(total/3.0)
+
+def candidate_errors(c, q2, natoms, lengths, volume, tolerance):
+    beta = ewald_coefficient(c['cutoff'], tolerance)
+    sizes = [grid_size(l, c['spacing']) for l in lengths]
+    er = real_error(q2, natoms, volume, c['cutoff'], beta)
+    ek = recip_error(q2, natoms, lengths, sizes, c['order'], beta)
+    return sizes, er, ek, math.sqrt(er*er + ek*ek)
+
+def step_time(output):
+    # median step time of the second half of the run
+    times = []
+    for line in open(output):
+        if line.startswith('[MO833] Paramount Iteration'):
+            times.append(float(line.split(',')[3]))
+    if not times:
+        for line in open(output):
+            m = re.search(r'Benchmark time: .* ([0-9.eE+-]+) s/step', line)
+            if m:
+                times.append(float(m.group(1)))
+    if not times:
+        return None
+    times = sorted(times[len(times)//2:])
+    return times[len(times)//2]
+
+def write_config(f, lines, c, skip=()):
+    # the base configuration with the tuned parameters replaced
+    for line in lines:
+        words = line.split('#')[0].split()
+        if words and (words[0].lower() in TUNED or words[0].lower() in skip):
+            continue
+        f.write(line)
+    f.write('\n' + snippet(c))
+
+def run(args, lines, base_dir, c, index):
+    config = os.path.join(base_dir, 'pmetune-%d.namd' % index)
+    output = os.path.join(base_dir, 'pmetune-%d.log' % index)
+    with open(config, 'w') as f:
+        write_config(f, lines, c, ('numsteps', 'run', 'minimize', 'outputenergies', 'restartfreq', 'dcdfreq'))
+        f.write('outputEnergies     %d\n' % args.steps)
+        f.write('restartfreq        0\n')
+        f.write('dcdfreq            0\n')
+        f.write('numsteps           %d\n' % args.steps)
+    command = []
+    if args.charmrun:
+        command = [args.charmrun, '+p%d' % args.pes] + args.charmrun_args.split() + [args.namd]
+    else:
+        command = [args.namd, '+p%d' % args.pes]
+    command += args.namd_args.split() + [os.path.basename(config)]
+    with open(output, 'w') as out:
+        status = subprocess.call(command, cwd=base_dir, stdout=out, stderr=subprocess.STDOUT)
+    t = step_time(output) if status == 0 else None
+    if not args.keep:
+        os.remove(config)
+        os.remove(output)
+    return t
+
+def snippet(c):
+    return ('cutoff             %g\n' % c['cutoff'] +
+            'switchdist         %g\n' % c['switchdist'] +
+            'pairlistdist       %g\n' % c['pairlistdist'] +
+            'PMEGridSpacing     %g\n' % c['spacing'] +
+            'PMEGridSizeX       %d\n' % c['sizes'][0] +
+            'PMEGridSizeY       %d\n' % c['sizes'][1] +
+            'PMEGridSizeZ       %d\n' % c['sizes'][2] +
+            'PMEInterpOrder     %d\n' % c['order'] +
+            'fullElectFrequency %d\n' % c['fullelect'])
+
+def main(args):
+    base_dir = os.path.dirname(os.path.abspath(args.config))
+    if not args.output:
+        args.output = os.path.join(base_dir, 'pmetune.namd')
+    options, lines = read_config(args.config)
+    if 'structure' not in options:
+        raise SystemExit('no structure in %s' % args.config)
+    natoms, q2 = read_charges(os.path.join(base_dir, options['structure']))
+    lengths, volume = read_cell(options, base_dir)
+    pme_tolerance = float(options.get('pmetolerance', '1e-6'))
+
+    cutoff = float(options['cutoff'])
+    switchdist = float(options.get('switchdist', cutoff))
+    pairlistdist = float(options.get('pairlistdist', cutoff))
+    order = int(options.get('pmeinterporder', '4'))
+    fullelect = int(options.get('fullelectfrequency', '1'))
+    stepspercycle = int(options.get('stepspercycle', '20'))
+
+    base = {'cutoff': cutoff, 'order': order, 'fullelect': fullelect,
+            'spacing': float(options.get('pmegridspacing', '1.5'))}
+    if order not in ACONS:
+        raise SystemExit('no error estimate for PMEInterpOrder %d' % order)
+    sizes, er, ek, err = candidate_errors(base, q2, natoms, lengths, volume, pme_tolerance)
+    if all(k in options for k in ('pmegridsizex', 'pmegridsizey', 'pmegridsizez')):
+        sizes = [int(options[k]) for k in ('pmegridsizex', 'pmegridsizey', 'pmegridsizez')]
+        beta = ewald_coefficient(cutoff, pme_tolerance)
+        ek = recip_error(q2, natoms, lengths, sizes, order, beta)
+        err = math.sqrt(er*er + ek*ek)
+    tolerance = args.tolerance if args.tolerance > 0 else err
+    print('%d atoms, cell %.2f x %.2f x %.2f A' % (natoms, lengths[0], lengths[1], lengths[2]))
+    print('Base: cutoff %g, grid %d %d %d, order %d: RMS force error %.3g (real %.3g, reciprocal %.3g) kcal/mol/A'
+          % (cutoff, sizes[0], sizes[1], sizes[2], order, err, er, ek))
+    print('Tolerance %.3g kcal/mol/A' % tolerance)
+
+    candidates = []
+    for cut in [float(x) for x in args.cutoffs.split(',')]:
+        for o in [int(x) for x in args.orders.split(',')]:
+            if o not in ACONS:
+                raise SystemExit('no error estimate for PMEInterpOrder %d' % o)
+            # coarsest grid meeting the tolerance for this cutoff and order
+            for spacing in sorted([float(x) for x in args.spacings.split(',')], reverse=True):
+                c = {'cutoff': cut, 'order': o, 'spacing': spacing}
+                sizes, er, ek, e = candidate_errors(c, q2, natoms, lengths, volume, pme_tolerance)
+                if e <= tolerance:
+                    break
+            else:
+                continue
+            for fe in [int(x) for x in args.fullelect.split(',')]:
+                if stepspercycle % fe:
+                    continue
+                if fe > fullelect and not args.allow_larger_fullelect:
+                    continue
+                candidates.append({'cutoff': cut, 'switchdist': cut - (cutoff - switchdist),
+                                   'pairlistdist': cut + (pairlistdist - cutoff),
+                                   'order': o, 'spacing': spacing, 'sizes': sizes, 'fullelect': fe,
+                                   'error': e, 'real': er, 'recip': ek, 'mts': fe > fullelect})
+
+    if not candidates:
+        raise SystemExit('no candidate meets the tolerance')
+    if any(c['mts'] for c in candidates):
+        print('fullElectFrequency above the base value %d is marked *: its multiple time stepping error'
+              ' is not in the estimate' % fullelect)
+
+    print('%-8s %-16s %-6s %-6s %-10s %-10s %-10s %s' % ('cutoff', 'grid', 'order', 'fullel', 'error', 'real', 'recip', 's/step'))
+    best = None
+    for index, c in enumerate(candidates):
+        t = None if args.dry_run else run(args, lines, base_dir, c, index)
+        c['time'] = t
+        print('%-8g %-16s %-6d %-6s %-10.3g %-10.3g %-10.3g %s'
+              % (c['cutoff'], '%d %d %d' % tuple(c['sizes']), c['order'],
+                 '%d%s' % (c['fullelect'], '*' if c['mts'] else ''),
+                 c['error'], c['real'], c['recip'], '-' if t is None else '%.6f' % t))
+        if t is not None and (best is None or t < best['time']):
+            best = c
+
+    if best is None:
+        if not args.dry_run:
+            print('No candidate completed')
+        return
+    with open(args.output, 'w') as f:
+        write_config(f, lines, best)
+        f.write('# tuned by pmetune.py for %d PEs: %.6f s/step, RMS force error %.3g kcal/mol/A\n'
+                % (args.pes, best['time'], best['error']))
+        if best['mts']:
+            f.write('# fullElectFrequency raised from %d to %d; its error is not in the estimate above\n'
+                    % (fullelect, best['fullelect']))
+    print('Fastest: cutoff %g, grid %d %d %d, order %d, fullElectFrequency %d; wrote %s'
+          % (best['cutoff'], best['sizes'][0], best['sizes'][1], best['sizes'][2],
+             best['order'], best['fullelect'], args.output))
+    if best['mts']:
+        print('Warning: fullElectFrequency %d is above the base value %d and outside the error estimate'
+              % (best['fullelect'], fullelect))
+
+if __name__ == '__main__':
+    parser = argparse.ArgumentParser(description='Tune cutoff and PME parameters under an error tolerance')
+    parser.add_argument('config', type=str, help='base NAMD configuration')
+    parser.add_argument('--namd', dest='namd', type=str, default='namd2', help='NAMD binary')
+    parser.add_argument('--namd-args', dest='namd_args', type=str, default='', help='extra NAMD arguments')
+    parser.add_argument('--charmrun', dest='charmrun', type=str, default='', help='charmrun for non-multicore builds')
+    parser.add_argument('--charmrun-args', dest='charmrun_args', type=str, default='', help='extra charmrun arguments')
+    parser.add_argument('--pes', dest='pes', type=int, default=1, help='PEs to tune for')
+    parser.add_argument('--steps', dest='steps', type=int, default=200, help='steps per candidate')
+    parser.add_argument('--tolerance', dest='tolerance', type=float, default=0.0,
+                        help='RMS force error in kcal/mol/A, default that of the base configuration')
+    parser.add_argument('--cutoffs', dest='cutoffs', type=str, default='9,10,11,12,14,16')
+    parser.add_argument('--spacings', dest='spacings', type=str, default='0.6,0.8,1.0,1.2,1.5,2.0,2.5')
+    parser.add_argument('--orders', dest='orders', type=str, default='4,6')
+    parser.add_argument('--fullelect', dest='fullelect', type=str, default='1,2,4',
+                        help='fullElectFrequency values, those not dividing stepspercycle or above that of the base'
+                        ' configuration are skipped')
+    parser.add_argument('--allow-larger-fullelect', dest='allow_larger_fullelect', action='store_true',
+                        help='also try fullElectFrequency above that of the base configuration, whose multiple'
+                        ' time stepping error is not estimated')
+    parser.add_argument('--dry-run', dest='dry_run', action='store_true', help='only print the error estimates')
+    parser.add_argument('--keep', dest='keep', action='store_true', help='keep candidate configs and logs')
+    parser.add_argument('-o', dest='output', type=str, default='',
+                        help='tuned configuration to write, default pmetune.namd next to the base configuration')
+    args = parser.parse_args()
+
+    main(args)
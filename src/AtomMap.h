@@ -9,6 +9,11 @@
  * patch ID (int) and local index (int) within that patch.
  * An array of "LocalID" of length (number of atoms) is allocated.
  * The total space required is 2*sizeof(int)*(number of atoms).
+ *
+ * With hashedAtomMap (or when built with -DNAMD_HASHED_ATOMMAP) the
+ * array is replaced by an open-addressing hash table holding only the
+ * home and proxy atoms of this PE, so that the space required scales
+ * with the atoms actually seen rather than with the system size.
  */
 
 #ifndef ATOMMAP_H
@@ -40,6 +45,8 @@ public:
   void allocateMap(int nAtomIDs);
 
   LocalID localID(AtomID id);
+  // look up n atoms at once
+  void localIDs(const AtomID *ids, LocalID *lids, int n);
 
   friend class AtomMapper;
 #ifdef NAMD_CUDA
@@ -65,18 +72,76 @@ private:
   LocalID *localIDTable;
   int tableSz;
 
+  // open-addressing hash with linear probing, id == notUsed if empty
+  struct HashEntry {
+    AtomID id;
+    LocalID lid;
+  };
+  HashEntry *hashTable;
+  int hashBits;
+  int hashCount;
+
+  inline unsigned int hashSlot(AtomID id) const {
+    return ( (unsigned int) id * 2654435761u ) >> ( 32 - hashBits );
+  }
+  inline LocalID hashLocalID(AtomID id) const;
+  void hashInsert(AtomID id, PatchID pid, int index);
+  void hashRemove(AtomID id, PatchID pid);
+  void hashResize(int bits);
+
 };
 
+//----------------------------------------------------------------------
+// Probe until the atom or an empty slot is found; the table is never
+// more than half full.
+inline LocalID AtomMap::hashLocalID(AtomID id) const
+{
+  const unsigned int mask = ( 1u << hashBits ) - 1;
+  unsigned int i = hashSlot(id);
+  while ( hashTable[i].id != id ) {
+    if ( hashTable[i].id == notUsed ) {
+      LocalID rval;
+      rval.pid = notUsed;
+      rval.index = notUsed;
+      return rval;
+    }
+    i = ( i + 1 ) & mask;
+  }
+  return hashTable[i].lid;
+}
+
 #ifndef MEM_OPT_VERSION
 //----------------------------------------------------------------------
 // LocalID contains patch pid and local patch atom index
 // for a given global atom number
 inline LocalID AtomMap::localID(AtomID id)
 {
+  if ( hashTable ) return hashLocalID(id);
   return localIDTable[id];
 }
 #endif
 
+//----------------------------------------------------------------------
+// All hash slots of a block are computed before any probing so that
+// the (mostly independent) table loads can overlap.
+inline void AtomMap::localIDs(const AtomID *ids, LocalID *lids, int n)
+{
+  if ( hashTable ) {
+    const int blockSize = 8;
+    unsigned int slot[blockSize];
+    for ( int i0=0; i0<n; i0+=blockSize ) {
+      const int nb = ( n - i0 < blockSize ) ? n - i0 : blockSize;
+      for ( int k=0; k<nb; ++k ) slot[k] = hashSlot(ids[i0+k]);
+      for ( int k=0; k<nb; ++k ) {
+        if ( hashTable[slot[k]].id == ids[i0+k] ) lids[i0+k] = hashTable[slot[k]].lid;
+        else lids[i0+k] = hashLocalID(ids[i0+k]);
+      }
+    }
+    return;
+  }
+  for ( int i=0; i<n; ++i ) lids[i] = localID(ids[i]);
+}
+
 
 class AtomMapper {
 public:
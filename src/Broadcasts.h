@@ -32,6 +32,7 @@ enum {
   SCRIPT_ATOMSEND,
   SCRIPT_ATOMRECV,
   SCRIPT_MINIMIZE,
+  SCRIPT_REDECOMPOSE,
   SCRIPT_DUMMY
 };
 
@@ -59,6 +60,7 @@ enum {
 #ifdef MEASURE_NAMD_WITH_PAPI
   papiMeasureTag,
 #endif
+  redecomposeTag,
   dummyTag
 };
 
@@ -87,6 +89,7 @@ struct ControllerBroadcasts
 #ifdef MEASURE_NAMD_WITH_PAPI
   SimpleBroadcastObject<int> papiMeasureBarrier;
 #endif
+  SimpleBroadcastObject<int> redecompose;
 
   ControllerBroadcasts(const LDObjHandle *ldObjPtr = 0) :
     velocityRescaleFactor(velocityRescaleFactorTag, ldObjPtr),
@@ -107,6 +110,7 @@ struct ControllerBroadcasts
     accelMDRescaleFactor(accelMDRescaleFactorTag, ldObjPtr),
     adaptTemperature(adaptTemperatureTag, ldObjPtr),
     scriptBarrier(scriptBarrierTag, ldObjPtr),
+    redecompose(redecomposeTag, ldObjPtr),
 #ifdef MEASURE_NAMD_WITH_PAPI
 	papiMeasureBarrier(papiMeasureTag, ldObjPtr),
 #endif
@@ -0,0 +1,59 @@
+/**
+***  Copyright (c) 1995, 1996, 1997, 1998, 1999, 2000 by
+***  The Board of Trustees of the University of Illinois.
+***  All rights reserved.
+**/
+
+/*
+   Packed copy of a patch's atoms for checkpoint/revert and the
+   checkpointStore family.  With compression the atoms are transposed
+   into byte planes (all first bytes, then all second bytes, ...), which
+   groups the slowly varying bytes of each field so that NAMD_compress
+   finds long runs, and may be stored as the XOR against another packed
+   copy (the delta base) of the same patch, which zeroes most planes.
+*/
+
+#ifndef CHECKPOINTATOMS_H
+#define CHECKPOINTATOMS_H
+
+#include <stddef.h>
+
+struct FullAtom;
+
+class CheckpointAtoms {
+public:
+  CheckpointAtoms() : numAtoms(0), data(0), len(0), shuffled(0),
+    compressed(0), base(0), numDependents(0) { }
+  ~CheckpointAtoms() { release(); }
+
+  // base is ignored without compression, if it has a different atom
+  // count or if it is itself stored as a delta
+  void pack(const FullAtom *atoms, int n, int compress,
+            const CheckpointAtoms *base = 0);
+  void unpack(FullAtom *atoms) const;
+
+  int size() const { return numAtoms; }
+  size_t rawBytes() const;
+  size_t storedBytes() const { return len; }
+  const CheckpointAtoms *deltaBase() const { return base; }
+  int hasDependents() const { return numDependents; }
+
+private:
+  int numAtoms;
+  char *data;
+  size_t len;
+  int shuffled;
+  int compressed;
+  const CheckpointAtoms *base;
+  mutable int numDependents;  // packed copies using this one as base
+
+  void release();
+  void planes(char *out) const;
+
+  // not copyable, as other copies may point to this one
+  CheckpointAtoms(const CheckpointAtoms &);
+  CheckpointAtoms &operator=(const CheckpointAtoms &);
+};
+
+#endif // CHECKPOINTATOMS_H
+
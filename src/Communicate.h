@@ -29,7 +29,7 @@ public:
   Communicate(void);
   ~Communicate();
   MIStream *newInputStream(int pe, int tag);
-  MOStream *newOutputStream(int pe, int tag, unsigned int bufsize);
+  MOStream *newOutputStream(int pe, int tag, unsigned int bufsize, int compress=0);
   void *getMessage(int PE, int tag);
   void sendMessage(int PE, void *msg, int size);
 };
@@ -0,0 +1,30 @@
+/**
+***  Copyright (c) 1995, 1996, 1997, 1998, 1999, 2000 by
+***  The Board of Trustees of the University of Illinois.
+***  All rights reserved.
+**/
+
+/*
+   Small dependency-free LZ77 byte compressor for data that NAMD ships
+   or keeps in memory in bulk, such as the structure broadcast.  It is
+   tuned for speed over ratio; the arrays it is used on are mostly
+   small integers and repeated records, which it handles well.
+*/
+
+#ifndef COMPRESS_H
+#define COMPRESS_H
+
+#include <stddef.h>
+
+// largest possible output of NAMD_compress() for len input bytes
+size_t NAMD_compress_bound(size_t len);
+
+// returns the compressed length; out must hold NAMD_compress_bound(len)
+size_t NAMD_compress(const char *in, size_t len, char *out);
+
+// returns the decompressed length, which is outlen for valid input,
+// or 0 if the input is corrupt or does not fit in outlen bytes
+size_t NAMD_decompress(const char *in, size_t len, char *out, size_t outlen);
+
+#endif
+
@@ -9,6 +9,7 @@
 
 #ifdef USE_HOMETUPLES
 #include <vector>
+#include <algorithm>
 #endif
 #include "NamdTypes.h"
 #include "common.h"
@@ -140,9 +141,40 @@ template <class T, class S, class P> class HomeTuples : public Tuples {
   protected:
     std::vector<T> tupleList;
 
+    // Tuples are listed under their first atom, so the tuples that may be
+    // computed here are those of the atoms in the scanned patches.  These
+    // candidates are kept between loads together with the patches their
+    // atoms were in, so that after migration only the tuples of atoms that
+    // entered or left the scanned patches are created or dropped and only
+    // tuples with an atom that changed patches are classified again; for
+    // all others the local indices are simply refreshed.
+    std::vector<T> candidateList;
+    std::vector<PatchID> candidatePid;   // T::size entries per candidate
+    std::vector<char> candidateState;    // -1 new, 0 not computed, 1 computed
+    std::vector<AtomID> scannedAtoms;    // sorted atom IDs of last load
+    std::vector<int> scannedPids;
+    std::vector<const CompAtomExt *> scanAtoms;
+    std::vector<AtomID> departedAtoms;
+    std::vector<const CompAtomExt *> arrivedAtoms;
+    bool candidatesValid;
+    const TuplePatchList *candidatePatchList;
+    int candidateNumPatches;
+    const Molecule *candidateMolecule;
+    const void *candidateStructs;
+    const P *candidateValues;
+    BigReal candidateLambda;
+    BigReal candidateLesFactor;
+    BigReal candidateSoluteScalingFactor;
+
+    struct AtomExtIDLess {
+      bool operator()(const CompAtomExt *a, const CompAtomExt *b) const {
+        return a->id < b->id;
+      }
+    };
+
   public:
 
-    HomeTuples(int type=-1) : Tuples(type) {}
+    HomeTuples(int type=-1) : Tuples(type), candidatesValid(false) {}
 
 #if __cplusplus < 201103L
 #define final
@@ -167,6 +199,147 @@ template <class T, class S, class P> class HomeTuples : public Tuples {
       return tupleList.size();
     }
 
+  protected:
+
+    //======================================================================
+    // addCandidates() - Append all tuples listed under atom a to the
+    // candidate list, unclassified
+    //======================================================================
+#ifdef MEM_OPT_VERSION
+    void addCandidates(const CompAtomExt &a,
+                       typename ElemTraits<T>::signature *allSigs,
+                       const P *tupleValues) {
+      int numTuples;
+      typename ElemTraits<T>::signature *thisAtomSig =
+               &allSigs[ElemTraits<T>::get_sig_id(a)];
+      TupleSignature *allTuples;
+      T::getTupleInfo(thisAtomSig, &numTuples, &allTuples);
+      for(int k=0; k<numTuples; k++) {
+        candidateList.push_back(T(a.id, &allTuples[k], tupleValues));
+#else
+    void addCandidates(const CompAtomExt &a, int32 **tuplesByAtom,
+                       S *tupleStructs, const P *tupleValues) {
+      int32 *curTuple = tuplesByAtom[a.id];
+      for( ; *curTuple != -1; ++curTuple) {
+        candidateList.push_back(T(&tupleStructs[*curTuple],tupleValues));
+#endif
+        for (int i=0; i < T::size; i++) candidatePid.push_back(notUsed);
+        candidateState.push_back(-1);
+      }
+    }
+
+    //======================================================================
+    // setupTuple() - Set scaling, patches and local indices of tuple t
+    // from the local IDs of its atoms.  Returns zero if t is not
+    // computed by this object.
+    //======================================================================
+    int setupTuple(T &t, const LocalID *aid, TuplePatchList& tuplePatchList,
+                   const char* isBasePatch, Node *node, PatchMap *patchMap) {
+
+      const SimParameters *simParams = node->simParameters;
+      const int lesOn = simParams->lesOn;
+      const int soluteScalingOn = simParams->soluteScalingOn;
+      const int fepOn = simParams->singleTopology;
+      const int sdScaling = simParams->sdScaling;
+
+      int partition[T::size];
+      register int i;
+      int homepatch = aid[0].pid;
+      int samepatch = 1;
+      partition[0] = fepOn ? node->molecule->get_fep_type(t.atomID[0]) : 0;  //using atom partition to determine if a bonded term to be scaled by lambda or 1-lambda in single topology relative FEP. 
+      int has_les = lesOn ? node->molecule->get_fep_type(t.atomID[0]) : 0;
+      int has_ss = soluteScalingOn ? node->molecule->get_ss_type(t.atomID[0]) : 0;
+      int is_fep_ss = partition[0] > 2;
+      int is_fep_sd = 0;
+      int fep_tuple_type = 0;
+      for (i=1; i < T::size; i++) {
+        samepatch = samepatch && ( homepatch == aid[i].pid );
+        partition[i] = fepOn ? node->molecule->get_fep_type(t.atomID[i]) : 0;
+        has_les |= lesOn ? node->molecule->get_fep_type(t.atomID[i]) : 0;
+        has_ss |= soluteScalingOn ? node->molecule->get_ss_type(t.atomID[i]) : 0;
+        if (fepOn) {
+        is_fep_ss &= partition[i] > 2;
+        is_fep_sd |= (abs(partition[i] - partition[0]) == 2);
+        fep_tuple_type = partition[i]; }
+      }
+      if (sdScaling && is_fep_sd) {
+        // check if this bonded term is one of Shobana term.
+        // This segment looks ugly and not GPU friendly,
+        // and might not appear in GPU code.
+        //
+        // XXX Could optimize in a number of ways:
+        // - could switch on T::size, then loop for that sized tuple
+        // - could use hash table to look up unpert_*[] elements
+        // - could add flag field to BondElem, et al., classes
+        const int num_unpert_bonds = node->molecule->num_alch_unpert_Bonds;
+        const int num_unpert_angles = node->molecule->num_alch_unpert_Angles;
+        const int num_unpert_dihedrals = node->molecule->num_alch_unpert_Dihedrals;
+        Bond *unpert_bonds = node->molecule->alch_unpert_bonds;
+        Angle *unpert_angles = node->molecule->alch_unpert_angles;
+        Dihedral *unpert_dihedrals = node->molecule->alch_unpert_dihedrals;
+        for (i=0; i < num_unpert_bonds; i++) {
+          if (T::size == 2
+              && t.atomID[0]==unpert_bonds[i].atom1
+              && t.atomID[1]==unpert_bonds[i].atom2) is_fep_sd = 0;
+        }
+        for (i=0; i < num_unpert_angles; i++) {
+          if (T::size == 3
+              && t.atomID[0]==unpert_angles[i].atom1
+              && t.atomID[1]==unpert_angles[i].atom2
+              && t.atomID[2]==unpert_angles[i].atom3) is_fep_sd = 0;
+        }
+        for (i=0; i < num_unpert_dihedrals; i++) {
+          if (T::size == 4
+              && t.atomID[0]==unpert_dihedrals[i].atom1
+              && t.atomID[1]==unpert_dihedrals[i].atom2
+              && t.atomID[2]==unpert_dihedrals[i].atom3
+              && t.atomID[3]==unpert_dihedrals[i].atom4) is_fep_sd = 0;
+        }
+      }
+      if (T::size < 4 && !simParams->soluteScalingAll) has_ss = false;
+      if ( samepatch ) return 0;
+      const BigReal Lambda = simParams->alchLambda;
+      const BigReal OneMinusLambda = 1.0 - Lambda;
+      t.scale = (!has_les && !has_ss) ? 1.0 :
+        ( has_les ? 1.0/simParams->lesFactor : simParams->soluteScalingFactor );
+      if (is_fep_ss) t.scale = (fep_tuple_type == 4) ? OneMinusLambda : Lambda;
+      if (is_fep_sd && sdScaling) t.scale = (fep_tuple_type == 4 || fep_tuple_type == 2) ? OneMinusLambda : Lambda;
+
+      for (i=1; i < T::size; i++) {
+        homepatch = patchMap->downstream(homepatch,aid[i].pid);
+      }
+      if ( homepatch == notUsed || ! isBasePatch[homepatch] ) return 0;
+
+      TuplePatchElem *p;
+      for (i=0; i < T::size; i++) {
+        t.p[i] = p = tuplePatchList.find(TuplePatchElem(aid[i].pid));
+        if ( ! p ) {
+          iout << iWARN << "Tuple with atoms ";
+          int erri;
+          for( erri = 0; erri < T::size; erri++ ) {
+            iout << t.atomID[erri] << "(" <<  aid[erri].pid << ") ";
+          }
+          iout << "missing patch " << aid[i].pid << "\n" << endi;
+          return 0;
+        }
+        t.localIndex[i] = aid[i].index;
+      }
+#ifdef MEM_OPT_VERSION
+      //avoid adding Tuples whose atoms are all fixed
+      if(simParams->fixedAtomsOn && !simParams->fixedAtomsForces) {
+        int allfixed = 1;
+        for(i=0; i<T::size; i++){
+          CompAtomExt *one = &(t.p[i]->xExt[aid[i].index]);
+          allfixed = allfixed & one->atomFixed;
+        }
+        if(allfixed) return 0;
+      }
+#endif
+      return 1;
+    }
+
+  public:
+
     virtual void loadTuples(TuplePatchList& tuplePatchList, const char* isBasePatch, AtomMap *atomMap,
       const std::vector<int>& pids = std::vector<int>()) {
 
@@ -174,11 +347,11 @@ template <class T, class S, class P> class HomeTuples : public Tuples {
         NAMD_bug("NULL isBasePatch detected in HomeTuples::loadTuples()");
       }
 
-      int numTuples;
-
 #ifdef MEM_OPT_VERSION
       typename ElemTraits<T>::signature *allSigs;      
+      const void *structs;
 #else
+      int numTuples;
       int32 **tuplesByAtom;
       /* const (need to propagate const) */ S *tupleStructs;
 #endif
@@ -186,48 +359,27 @@ template <class T, class S, class P> class HomeTuples : public Tuples {
       const P *tupleValues;
       Node *node = Node::Object();
       PatchMap *patchMap = PatchMap::Object();
-      // AtomMap *atomMap = AtomMap::Object();
+      const SimParameters *simParams = node->simParameters;
 
 #ifdef MEM_OPT_VERSION
       allSigs = ElemTraits<T>::get_sig_pointer(node->molecule);
+      structs = allSigs;
 #else      
       T::getMoleculePointers(node->molecule,
         &numTuples, &tuplesByAtom, &tupleStructs);      
+      const void *structs = tupleStructs;
 #endif
       
       T::getParameterPointers(node->parameters, &tupleValues);
 
-      tupleList.clear();
-
-      LocalID aid[T::size];
-      int partition[T::size];
-
-      const int lesOn = node->simParameters->lesOn;
-      const int soluteScalingOn = node->simParameters->soluteScalingOn;
-      const int fepOn = node->simParameters->singleTopology;
-      const int sdScaling = node->simParameters->sdScaling;
-      Real invLesFactor = lesOn ? 
-                          1.0/node->simParameters->lesFactor :
-                          1.0;
-      const Real soluteScalingFactor = node->simParameters->soluteScalingFactor;
-      const Bool soluteScalingAll = node->simParameters->soluteScalingAll;
-      BigReal OneMinusLambda = 1.0 - node->simParameters->alchLambda;
-      BigReal Lambda = node->simParameters->alchLambda;
-      const int num_unpert_bonds = node->molecule->num_alch_unpert_Bonds;
-      const int num_unpert_angles = node->molecule->num_alch_unpert_Angles;
-      const int num_unpert_dihedrals = node->molecule->num_alch_unpert_Dihedrals;
-      Bond *unpert_bonds = node->molecule->alch_unpert_bonds;
-      Angle *unpert_angles = node->molecule->alch_unpert_angles;
-      Dihedral *unpert_dihedrals = node->molecule->alch_unpert_dihedrals;
-
-      // cycle through each patch and gather all tuples
+      // cycle through each patch and gather its atoms
       TuplePatchListIter ai(tuplePatchList);
       if (pids.size() == 0) ai = ai.begin();
 
       int numPid = (pids.size() == 0) ? tuplePatchList.size() : pids.size();
 
+      scanAtoms.clear();
       for (int ipid=0;ipid < numPid;ipid++) {
-        // Patch *patch;
         int numAtoms;
         CompAtomExt *atomExt;
         // Take next patch
@@ -242,121 +394,119 @@ template <class T, class S, class P> class HomeTuples : public Tuples {
           numAtoms = patch->getNumAtoms();
           atomExt = tpe->xExt;          
         }
-   
-        // cycle through each atom in the patch and load up tuples
-        for (int j=0; j < numAtoms; j++)
-        {
-          /* cycle through each tuple */
+        for (int j=0; j < numAtoms; j++) scanAtoms.push_back(atomExt + j);
+      }
+      std::sort(scanAtoms.begin(), scanAtoms.end(), AtomExtIDLess());
+
+      // Candidates are rebuilt from scratch when anything they depend on
+      // besides atom positions has changed or when too many atoms moved.
+      int rebuild = ! candidatesValid || pids != scannedPids ||
+        candidatePatchList != &tuplePatchList ||
+        candidateNumPatches != tuplePatchList.size() ||
+        candidateMolecule != node->molecule || candidateStructs != structs ||
+        candidateValues != tupleValues ||
+        candidateLambda != simParams->alchLambda ||
+        candidateLesFactor != simParams->lesFactor ||
+        candidateSoluteScalingFactor != simParams->soluteScalingFactor;
+
+      if ( ! rebuild ) {
+        departedAtoms.clear();
+        arrivedAtoms.clear();
+        const int numOld = scannedAtoms.size();
+        const int numNew = scanAtoms.size();
+        int iold = 0, inew = 0;
+        while ( iold < numOld || inew < numNew ) {
+          if ( inew == numNew ||
+               ( iold < numOld && scannedAtoms[iold] < scanAtoms[inew]->id ) ) {
+            departedAtoms.push_back(scannedAtoms[iold++]);
+          } else if ( iold == numOld || scanAtoms[inew]->id < scannedAtoms[iold] ) {
+            arrivedAtoms.push_back(scanAtoms[inew++]);
+          } else {
+            ++iold;  ++inew;
+          }
+        }
+        if ( 2 * (int)( departedAtoms.size() + arrivedAtoms.size() ) > numNew ) {
+          rebuild = 1;
+        }
+      }
+
+      if ( rebuild ) {
+        candidateList.clear();
+        candidatePid.clear();
+        candidateState.clear();
+        for (int j=0; j < scanAtoms.size(); j++) {
 #ifdef MEM_OPT_VERSION
-          typename ElemTraits<T>::signature *thisAtomSig =
-                   &allSigs[ElemTraits<T>::get_sig_id(atomExt[j])];
-          TupleSignature *allTuples;
-          T::getTupleInfo(thisAtomSig, &numTuples, &allTuples);
-          for(int k=0; k<numTuples; k++) {
-            T t(atomExt[j].id, &allTuples[k], tupleValues);
+          addCandidates(*scanAtoms[j], allSigs, tupleValues);
 #else
-          /* get list of all tuples for the atom */
-          int32 *curTuple = tuplesByAtom[atomExt[j].id];
-          for( ; *curTuple != -1; ++curTuple) {
-            T t(&tupleStructs[*curTuple],tupleValues);
-#endif            
-            register int i;
-            aid[0] = atomMap->localID(t.atomID[0]);
-            int homepatch = aid[0].pid;
-            int samepatch = 1;
-            partition[0] = fepOn ? node->molecule->get_fep_type(t.atomID[0]) : 0;  //using atom partition to determine if a bonded term to be scaled by lambda or 1-lambda in single topology relative FEP. 
-            int has_les = lesOn ? node->molecule->get_fep_type(t.atomID[0]) : 0;
-            int has_ss = soluteScalingOn ? node->molecule->get_ss_type(t.atomID[0]) : 0;
-            int is_fep_ss = partition[0] > 2;
-            int is_fep_sd = 0;
-            int fep_tuple_type = 0;
-            for (i=1; i < T::size; i++) {
-              aid[i] = atomMap->localID(t.atomID[i]);
-              samepatch = samepatch && ( homepatch == aid[i].pid );
-              partition[i] = fepOn ? node->molecule->get_fep_type(t.atomID[i]) : 0;
-              has_les |= lesOn ? node->molecule->get_fep_type(t.atomID[i]) : 0;
-              has_ss |= soluteScalingOn ? node->molecule->get_ss_type(t.atomID[i]) : 0;
-              if (fepOn) {
-              is_fep_ss &= partition[i] > 2;
-              is_fep_sd |= (abs(partition[i] - partition[0]) == 2);
-              fep_tuple_type = partition[i]; }
-            }
-            if (sdScaling && is_fep_sd) {
-              // check if this bonded term is one of Shobana term.
-              // This segment looks ugly and not GPU friendly,
-              // and might not appear in GPU code.
-              //
-              // XXX Could optimize in a number of ways:
-              // - could switch on T::size, then loop for that sized tuple
-              // - could use hash table to look up unpert_*[] elements
-              // - could add flag field to BondElem, et al., classes
-              for (i=0; i < num_unpert_bonds; i++) {
-                if (T::size == 2
-                    && t.atomID[0]==unpert_bonds[i].atom1
-                    && t.atomID[1]==unpert_bonds[i].atom2) is_fep_sd = 0;
-              }
-              for (i=0; i < num_unpert_angles; i++) {
-                if (T::size == 3
-                    && t.atomID[0]==unpert_angles[i].atom1
-                    && t.atomID[1]==unpert_angles[i].atom2
-                    && t.atomID[2]==unpert_angles[i].atom3) is_fep_sd = 0;
-              }
-              for (i=0; i < num_unpert_dihedrals; i++) {
-                if (T::size == 4
-                    && t.atomID[0]==unpert_dihedrals[i].atom1
-                    && t.atomID[1]==unpert_dihedrals[i].atom2
-                    && t.atomID[2]==unpert_dihedrals[i].atom3
-                    && t.atomID[3]==unpert_dihedrals[i].atom4) is_fep_sd = 0;
+          addCandidates(*scanAtoms[j], tuplesByAtom, tupleStructs, tupleValues);
+#endif
+        }
+      } else {
+        if ( departedAtoms.size() ) {
+          // departedAtoms is sorted by construction
+          int k = 0;
+          const int numCand = candidateList.size();
+          for (int c=0; c < numCand; c++) {
+            if ( std::binary_search(departedAtoms.begin(), departedAtoms.end(),
+                                    candidateList[c].atomID[0]) ) continue;
+            if ( k != c ) {
+              candidateList[k] = candidateList[c];
+              candidateState[k] = candidateState[c];
+              for (int i=0; i < T::size; i++) {
+                candidatePid[k*T::size+i] = candidatePid[c*T::size+i];
               }
             }
-            if (T::size < 4 && !soluteScalingAll) has_ss = false;
-            if ( samepatch ) continue;
-            t.scale = (!has_les && !has_ss) ? 1.0 : ( has_les ? invLesFactor : soluteScalingFactor );
-            if (is_fep_ss) t.scale = (fep_tuple_type == 4) ? OneMinusLambda : Lambda;
-            if (is_fep_sd && sdScaling) t.scale = (fep_tuple_type == 4 || fep_tuple_type == 2) ? OneMinusLambda : Lambda;
-
-            for (i=1; i < T::size; i++) {
-              homepatch = patchMap->downstream(homepatch,aid[i].pid);
-            }
-            if ( homepatch != notUsed && isBasePatch[homepatch] ) {
-              TuplePatchElem *p;
-              for (i=0; i < T::size; i++) {
-                t.p[i] = p = tuplePatchList.find(TuplePatchElem(aid[i].pid));
-                if ( ! p ) {
+            ++k;
+          }
+          candidateList.erase(candidateList.begin() + k, candidateList.end());
+          candidateState.erase(candidateState.begin() + k, candidateState.end());
+          candidatePid.erase(candidatePid.begin() + k*T::size, candidatePid.end());
+        }
+        for (int j=0; j < arrivedAtoms.size(); j++) {
 #ifdef MEM_OPT_VERSION
-                  iout << iWARN << "Tuple with atoms ";
+          addCandidates(*arrivedAtoms[j], allSigs, tupleValues);
 #else
-                  iout << iWARN << "Tuple " << *curTuple << " with atoms ";
+          addCandidates(*arrivedAtoms[j], tuplesByAtom, tupleStructs, tupleValues);
 #endif
-                  int erri;
-                  for( erri = 0; erri < T::size; erri++ ) {
-                    iout << t.atomID[erri] << "(" <<  aid[erri].pid << ") ";
-                  }
-                  iout << "missing patch " << aid[i].pid << "\n" << endi;
-                  break;
-                }
-                t.localIndex[i] = aid[i].index;
-              }
-              if ( ! p ) continue;
-#ifdef MEM_OPT_VERSION
-              //avoid adding Tuples whose atoms are all fixed
-              if(node->simParameters->fixedAtomsOn && !node->simParameters->fixedAtomsForces) {
-                int allfixed = 1;
-                for(i=0; i<T::size; i++){
-                  CompAtomExt *one = &(t.p[i]->xExt[aid[i].index]);
-                  allfixed = allfixed & one->atomFixed;
-                }
-                if(!allfixed) tupleList.push_back(t);
-              }else{
-                tupleList.push_back(t);
-              }
-#else
-              tupleList.push_back(t);
-#endif               
-            }
-          }
         }
       }
+
+      scannedAtoms.resize(scanAtoms.size());
+      for (int j=0; j < scanAtoms.size(); j++) scannedAtoms[j] = scanAtoms[j]->id;
+      scannedPids = pids;
+      candidatePatchList = &tuplePatchList;
+      candidateNumPatches = tuplePatchList.size();
+      candidateMolecule = node->molecule;
+      candidateStructs = structs;
+      candidateValues = tupleValues;
+      candidateLambda = simParams->alchLambda;
+      candidateLesFactor = simParams->lesFactor;
+      candidateSoluteScalingFactor = simParams->soluteScalingFactor;
+      candidatesValid = true;
+
+      // Only tuples with an atom in a different patch than at the last
+      // load need to be classified again.
+      tupleList.clear();
+      LocalID aid[T::size];
+      const int numCand = candidateList.size();
+      for (int c=0; c < numCand; c++) {
+        T &t = candidateList[c];
+        PatchID *cpid = &candidatePid[c*T::size];
+        int moved = ( candidateState[c] < 0 );
+        register int i;
+        atomMap->localIDs(t.atomID, aid, T::size);
+        for (i=0; i < T::size; i++) {
+          moved |= ( aid[i].pid != cpid[i] );
+        }
+        if ( moved ) {
+          candidateState[c] = setupTuple(t, aid, tuplePatchList, isBasePatch,
+                                         node, patchMap);
+          for (i=0; i < T::size; i++) cpid[i] = aid[i].pid;
+        } else if ( candidateState[c] ) {
+          for (i=0; i < T::size; i++) t.localIndex[i] = aid[i].index;
+        }
+        if ( candidateState[c] ) tupleList.push_back(t);
+      }
     }
 
 };
@@ -618,6 +768,15 @@ template <class T, class S, class P> class ComputeHomeTuples : public Compute {
   public:
   
     virtual ~ComputeHomeTuples() {
+      UniqueSetIter<TuplePatchElem> ap(tuplePatchList);
+      for (ap = ap.begin(); ap != ap.end(); ap++) {
+        if ( ap->positionBox )
+          ap->p->unregisterPositionPickup(this,&(ap->positionBox));
+        if ( ap->avgPositionBox )
+          ap->p->unregisterAvgPositionPickup(this,&(ap->avgPositionBox));
+        if ( ap->forceBox )
+          ap->p->unregisterForceDeposit(this,&(ap->forceBox));
+      }
       delete reduction;
       delete [] isBasePatch;
       delete pressureProfileReduction;
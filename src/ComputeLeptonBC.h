@@ -0,0 +1,42 @@
+/**
+***  Copyright (c) 1995, 1996, 1997, 1998, 1999, 2000 by
+***  The Board of Trustees of the University of Illinois.
+***  All rights reserved.
+**/
+
+/*
+   Boundary forces from a per-atom energy expression given in the
+   config file, compiled with Lepton.  Gradients are derived
+   analytically, so no Tcl is involved while running.
+*/
+
+#ifndef COMPUTELEPTONBC_H
+#define COMPUTELEPTONBC_H
+
+#include "ComputeHomePatch.h"
+#include "ReductionMgr.h"
+
+namespace Lepton {
+  class CompiledExpression;
+}
+
+class ComputeLeptonBC : public ComputeHomePatch
+{
+public:
+  ComputeLeptonBC(ComputeID c, PatchID pid);
+  virtual ~ComputeLeptonBC();
+  virtual void doForce(FullAtom* p, Results* r);
+
+private:
+  SubmitReduction *reduction;
+  int wrapmode;
+
+  Lepton::CompiledExpression *energyExpr;
+  Lepton::CompiledExpression *gradExpr[3];  // NULL if identically zero
+
+  // storage for the expression variables
+  double x, y, z, charge, mass, id, step;
+};
+
+#endif
+
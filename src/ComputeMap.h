@@ -76,6 +76,7 @@ enum ComputeType
   computeSphericalBCType,
   computeCylindricalBCType,
   computeTclBCType,
+  computeLeptonBCType,
   computeRestraintsType,
   computeConsForceType,
   computeConsTorqueType,
@@ -147,6 +148,9 @@ public:
 
   int allocateCids();
 
+  // empty the map before re-decomposition, once per process
+  void reset();
+
   // storeCompute(cid,node,maxPids) tells the ComputeMap to store
   // information about the indicated patch, and allocate space
   // for up to maxPids dependents
@@ -68,6 +68,8 @@ public:
   void splitComputes2(CkQdMsg *);
   void updateLocalComputes();
   void updateLocalComputes2(CkQdMsg *);
+  // new compute map from Node::redecompose(), split computes again
+  void resetSplitting() { skipSplitting = 0; }
   void updateLocalComputes3();
   void updateLocalComputes4(CkQdMsg *);
   void updateLocalComputes5();
@@ -276,6 +276,8 @@ void ComputeNonbondedUtil :: NAME
   const int doLoweAndersen = params->doLoweAndersen;
   // END LA
 
+  FAST( BigReal *rdfHistogram = params->rdfHistogram; )
+
   // local variables
   int exclChecksum = 0;
   FAST
@@ -1968,6 +1970,28 @@ void ComputeNonbondedUtil :: NAME
 #endif
     // END LA
 
+    // in-situ RDF: count the normal pairs between the two atom sets
+#if (FAST(1+)0)
+    if ( rdfHistogram ) {
+      const int rdfGroups_i = mol->get_analysis_rdf_groups(pExt_0[i].id);
+      if ( rdfGroups_i ) {
+	for (k = 0; k < npairi; k++) {
+	  const int rdfGroups_j =
+		mol->get_analysis_rdf_groups(pExt_1[pairlisti[k]].id);
+	  // ordered pairs (i,j) and (j,i) with the first atom in set A
+	  const int npair = ( (rdfGroups_i & 1) && (rdfGroups_j & 2) ) +
+			    ( (rdfGroups_i & 2) && (rdfGroups_j & 1) );
+	  if ( ! npair ) continue;
+	  NOKNL( const BigReal r = sqrt(r2list[k] - r2_delta); )
+	  KNL( const BigReal r = sqrt(r2list_f[k]); )
+	  int bin = (int) ( r * analysisRDFInvWidth );
+	  if ( bin >= analysisRDFBins ) bin = analysisRDFBins - 1;
+	  rdfHistogram[bin] += npair;
+	}
+      }
+    }
+#endif
+
 #define NORMAL(X) X
 #define EXCLUDED(X)
 #define MODIFIED(X)
@@ -37,11 +37,14 @@ protected :
   Box<Patch,Real> *dHdrPrefixBox[2];//read
   static const int numGBISPairlists = 4;
   Pairlists gbisStepPairlists[numGBISPairlists];//lasts a step
+  Pairlists gbisCandidatePairlists;//lasts a pairlist cycle
 
   BigReal reductionData[reductionDataSize];
   SubmitReduction *reduction;
   SubmitReduction *pressureProfileReduction;
   BigReal *pressureProfileData;
+  SubmitReduction *analysisReduction;
+  BigReal *analysisData;
 
   ComputeNonbondedWorkArrays* const workArrays;
 
@@ -38,10 +38,13 @@ protected :
   Box<Patch,Real> *dHdrPrefixBox;
   static const int numGBISPairlists = 4;
   Pairlists gbisStepPairlists[numGBISPairlists];
+  Pairlists gbisCandidatePairlists;
 
   SubmitReduction *reduction;
   SubmitReduction *pressureProfileReduction;
   BigReal *pressureProfileData;
+  SubmitReduction *analysisReduction;
+  BigReal *analysisData;
 
   ComputeNonbondedWorkArrays* const workArrays;
 
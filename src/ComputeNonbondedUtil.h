@@ -184,6 +184,7 @@ struct GBISParamStruct {
   int doFullElectrostatics;
   int doEnergy;
   Pairlists *gbisStepPairlists[4];
+  Pairlists *gbisCandidatePairlists;
   BigReal maxGroupRadius;
 };
 
@@ -213,6 +214,7 @@ struct nonbonded {
 
   BigReal *reduction;
   BigReal *pressureProfileReduction;
+  BigReal *rdfHistogram;  // in-situ RDF pair counts, or NULL
 
   Parameters *parameters;
   SimParameters *simParameters;
@@ -282,6 +284,7 @@ public:
 	 reductionDataSize };
   static void submitReductionData(BigReal*,SubmitReduction*);
   static void submitPressureProfileData(BigReal*,SubmitReduction*);
+  static void submitAnalysisData(BigReal*,SubmitReduction*);
 
   static Bool commOnly;
   static Bool fixedAtomsOn;
@@ -383,6 +386,13 @@ public:
   static BigReal pressureProfileThickness;
   static BigReal pressureProfileMin;
 
+  // in-situ RDF, counted in REDUCTIONS_ANALYSIS
+  static Bool analysisRDFOn;
+  static int analysisRDFBins;
+  static BigReal analysisRDFInvWidth;
+  static int analysisRDFOffset;
+  static int analysisSize;
+
   static Bool accelMDOn;
 
   static Bool drudeNbthole;
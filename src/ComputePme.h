@@ -98,5 +98,10 @@ public:
 
 ResizeArray<ComputePme*>& getComputes(ComputePmeMgr *mgr) ;
 
+// patch re-decomposition within a run, called from Node::redecompose()
+int pmeUsesPencils();
+void pmeClearComputes();
+void pmeReinitRouting();
+
 #endif
 
@@ -28,6 +28,7 @@ class CollectionMaster;
 
 class Random;
 class PressureProfileReduction;
+class InSituAnalysis;
 
 struct ControllerState {
     Tensor langevinPiston_strainRate;
@@ -58,8 +59,13 @@ protected:
     void integrate(int); // Verlet integrator
     void minimize(); // CG minimizer
       RequireReduction *min_reduction;
+    void minimizeLBFGSDirection(int &minSeq, int step);
+      RequireReduction *lbfgs_reduction;
+      int lbfgsHistory;   // number of correction pairs on the Sequencers
+      int lbfgsDirStep;   // step of the last new direction
 
     void receivePressure(int step, int minimize = 0);
+    int reductionLag(int step);
     void calcPressure(int step, int minimize,
       const Tensor& virial_normal_in, const Tensor& virial_nbond_in, const Tensor& virial_slow_in,
       const Tensor& intVirial_normal, const Tensor& intVirial_nbond, const Tensor& intVirial_slow,
@@ -89,7 +95,12 @@ protected:
       int computeChecksum;
       int marginViolations;
       int pairlistWarnings;
+    int redecompose(int step);
+      int redecomposeViolations;
+      int redecomposeStep;
     void printTiming(int);
+      BigReal migrationAtoms;
+      BigReal migrationTime;
     void printMinimizeEnergies(int);
       BigReal min_energy;
       BigReal min_f_dot_f;
@@ -246,6 +257,11 @@ protected:
     int pressureProfileCount;
     BigReal *pressureProfileAverage;
 
+    // in-situ analyses
+    InSituAnalysis *analysis;
+    RequireReduction *analysisReduction;
+    void outputAnalysis(int step);
+
     CollectionMaster *const collection;
     
     ControllerBroadcasts * broadcast;
@@ -11,6 +11,11 @@
 #include "imd.h"
 #include "ResizeArray.h"
 
+#if ! defined(WIN32) || defined(__CYGWIN__)
+#define IMD_SEND_THREAD
+#include <pthread.h>
+#endif
+
 class FloatVector;
 
 class GlobalMasterIMD : public GlobalMaster {
@@ -46,9 +51,55 @@ class GlobalMasterIMD : public GlobalMaster {
   // Connected sockets
   ResizeArray<void *>clients;
 
-  // temporaries in case 3*sizeof(float) != sizeof(FloatVector)
-  float *coordtmp;
-  int coordtmpsize;
+  // Atoms sent to clients, in the order the clients index them;
+  // empty if all atoms are sent.
+  ResizeArray<int> subset;
+
+  // Packed IMD messages.  Coordinates are packed into fillCoords and,
+  // with the sender thread, swapped into pendingCoords for the thread,
+  // which replaces a frame the thread has not picked up yet rather than
+  // waiting for it; the thread sends from sendCoords.
+  struct PackedMsg {
+    char *buf;
+    int32 size;
+    int32 alloc;
+    PackedMsg() : buf(0), size(0), alloc(0) { }
+    ~PackedMsg() { delete [] buf; }
+    void swap(PackedMsg &m);
+  };
+  PackedMsg fillCoords, pendingCoords, sendCoords;
+  PackedMsg pendingEnergies, sendEnergies;
+
+  // Writes m to each socket that becomes writable within waitSec seconds;
+  // returns the number of sockets skipped.
+  int send_packed(const ResizeArray<void *> &socks, const PackedMsg &m,
+                  int waitSec);
+
+  // Removes and destroys a client socket.
+  void remove_client(int i);
+
+#ifdef IMD_SEND_THREAD
+  int useThread;
+  int stopThread;
+  int framesDropped;
+  pthread_t sendThread;
+  pthread_mutex_t queueLock;  // guards the pending messages and flags
+  pthread_cond_t queueCond;
+  // Guards clients, sending and closedClients.  The thread copies the
+  // clients into sendClients and writes without holding the lock; a
+  // client removed meanwhile is shut down and left in closedClients for
+  // the thread to destroy once its writes are done.
+  pthread_mutex_t clientLock;
+  ResizeArray<void *> sendClients;
+  ResizeArray<void *> closedClients;
+  int sending;
+  static void *send_thread(void *);
+  void lock_clients() { if ( useThread ) pthread_mutex_lock(&clientLock); }
+  void unlock_clients() { if ( useThread ) pthread_mutex_unlock(&clientLock); }
+#else
+  void lock_clients() { }
+  void unlock_clients() { }
+#endif
 };
 
 #endif
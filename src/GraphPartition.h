@@ -0,0 +1,56 @@
+/**
+***  Copyright (c) 1995, 1996, 1997, 1998, 1999, 2000 by
+***  The Board of Trustees of the University of Illinois.
+***  All rights reserved.
+**/
+
+/*
+   Multilevel graph partitioner used for initial patch placement.
+   Parts are produced by recursive bisection; each bisection coarsens
+   the graph by heavy edge matching, bisects the coarsest graph by greedy
+   graph growing and refines the cut with Fiduccia-Mattheyses passes
+   while projecting back to the original graph.
+*/
+
+#ifndef GRAPHPARTITION_H
+#define GRAPHPARTITION_H
+
+#include <vector>
+
+class GraphPartition {
+public:
+  GraphPartition(int numVertices);
+
+  void setVertexWeight(int v, double w) { vwgt[v] = w; }
+  // undirected, repeated edges are merged by adding their weights
+  void addEdge(int u, int v, double w);
+
+  // Divide the vertices into numParts parts, part k receiving the
+  // fraction partWeights[k] / sum(partWeights) of the vertex weight,
+  // so that the total weight of edges cut is small.
+  void partition(int numParts, const double *partWeights, int *part);
+
+  // total weight of edges between different parts
+  double edgeCut(const int *part) const;
+  double totalEdgeWeight() const;
+
+  struct Graph {
+    std::vector<int> xadj;  // adjacency of v is adj[xadj[v]..xadj[v+1])
+    std::vector<int> adj;
+    std::vector<double> ewgt;
+    std::vector<double> vwgt;
+    int numVertices() const { return vwgt.size(); }
+  };
+
+private:
+  struct Edge { int u, v; double w; };
+  std::vector<Edge> edges;
+  std::vector<double> vwgt;
+
+  void buildGraph(Graph &g) const;
+  void recursiveBisect(const Graph &g, const std::vector<int> &ids,
+                       const double *partWeights, int p0, int p1, int *part);
+};
+
+#endif
+
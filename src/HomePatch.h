@@ -23,6 +23,7 @@
 #include "common.h"
 #include "Migration.h"
 #include "Settle.h"
+#include "CheckpointAtoms.h"
 
 #include <string>
 #include <map>
@@ -331,6 +332,10 @@ public:
   // Signal HomePatch that positions stored are to be now to be used
   void positionsReady(int doMigration=0);
   int marginViolations;
+  // atom migration volume and time not spent waiting for neighbors,
+  // summed since last cleared by the Sequencer
+  int migrationAtomsOut;
+  double migrationTime;
 
   // methods to implement integration
   void saveForce(const int ftag = Results::normal);
@@ -429,10 +434,12 @@ public:
   struct checkpoint_t {
     Lattice lattice;
     int berendsenPressure_count;
-    int numAtoms;
-    ResizeArray<FullAtom> atoms;
+    CheckpointAtoms atoms;
   };
   std::map<std::string,checkpoint_t*> checkpoints;
+  void releaseCheckpointBase(checkpoint_t *cp);
+  const CheckpointAtoms *checkpointBase(int numAtoms, const checkpoint_t *skip);
+  int loadAtoms(const FullAtom *a, int n, const Lattice &l);
 
   // replica exchange
   void exchangeAtoms(int scriptTask);
@@ -489,6 +496,7 @@ protected:
   void doGroupSizeCheck();
   void doMarginCheck();
   void doAtomMigration();
+  void sortAtomsForLocality();
   int inMigration;
   int numMlBuf;
   MigrateAtomsMsg *msgbuf[PatchMap::MaxOneAway];
@@ -506,13 +514,13 @@ private:
     FullAtomList tempAtom;  // A temporary array used to sort waters
                             //   from non-waters in the atom array
     void separateAtoms();   // Function to separate the atoms currently in atoms.
-    void mergeAtomList(FullAtomList &al);  // Function to combine and separate
+    void mergeAtomList(FullAtom *al, int alSize);  // Function to combine and separate
                                            //   the atoms in al with atoms.
   #endif
 
 
   // checkpointed state
-  FullAtomList  checkpoint_atom;
+  CheckpointAtoms  checkpoint_atom;
   Lattice  checkpoint_lattice;
 
   // DMK - Atom Separation (water vs. non-water)
@@ -0,0 +1,84 @@
+/**
+***  Copyright (c) 1995, 1996, 1997, 1998, 1999, 2000 by
+***  The Board of Trustees of the University of Illinois.
+***  All rights reserved.
+**/
+
+/*
+   In-situ analyses, computed while the simulation runs instead of from
+   trajectory files afterwards.  Every analysisFreq steps each home patch
+   adds the partial sums of its atoms into REDUCTIONS_ANALYSIS; the
+   controller turns the reduced sums into results, averages them and
+   writes the averages every analysisOutputFreq steps, one file per
+   analysis.  An analysis derives from AnalysisStage and is added to the
+   list in the InSituAnalysis constructor.  The radial distribution
+   function also needs the atom pairs, which the nonbonded computes add
+   into the same reduction on steps with Flags::doAnalysis set.
+*/
+
+#ifndef INSITUANALYSIS_H
+#define INSITUANALYSIS_H
+
+#include "NamdTypes.h"
+#include "ResizeArray.h"
+
+class Lattice;
+class SubmitReduction;
+class RequireReduction;
+class ofstream_namd;
+
+class AnalysisStage {
+public:
+  virtual ~AnalysisStage() { }
+
+  // file name suffix appended to analysisFile
+  virtual const char *suffix() const = 0;
+
+  // number of reduction items
+  virtual int size() const = 0;
+
+  // on each PE: add the partial sums of the atoms of one patch
+  virtual void submit(const FullAtom *a, int n, const Lattice &lattice,
+                      BigReal *sums) const = 0;
+
+  // on the controller: add the results of one sample to the average
+  virtual void sample(const BigReal *sums, const Lattice &lattice) = 0;
+
+  // on the controller: write the column labels, or write and clear
+  // the average
+  virtual void writeLabels(ofstream_namd &file) const = 0;
+  virtual void write(int step, ofstream_namd &file) = 0;
+};
+
+class InSituAnalysis {
+public:
+  InSituAnalysis();
+  ~InSituAnalysis();
+
+  int size() const { return numItems; }
+
+  // first reduction item of the RDF pair histogram, or -1
+  int rdfHistogramOffset() const { return rdfOffset; }
+
+  static int sampleNeeded(int step);
+  static int outputNeeded(int step);
+
+  // on each PE, for one patch
+  void submit(const FullAtom *a, int n, const Lattice &lattice,
+              SubmitReduction *reduction) const;
+
+  // on the controller, after the reduction for step has been required
+  void sample(int step, const RequireReduction *reduction,
+              const Lattice &lattice);
+
+private:
+  ResizeArray<AnalysisStage *> stages;
+  ResizeArray<int> offsets;
+  ResizeArray<ofstream_namd *> files;
+  int numItems;
+  int rdfOffset;
+  BigReal *sums;
+};
+
+#endif // INSITUANALYSIS_H
+
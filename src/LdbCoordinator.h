@@ -76,6 +76,7 @@ class Sequencer;
 class computeInfo;
 class patchInfo;
 class processorInfo;
+class LdbProfile;
 
 enum {LDB_PATCHES = 4096};
 enum {LDB_COMPUTES = 16384};
@@ -131,6 +132,8 @@ public:
   void RecvMigrate(LdbMigrateMsg*);
   void ExpectMigrate(LdbMigrateMsg*);
   void ResumeFromSync(void);
+  int isLdbCompute(ComputeID cid);
+  void unregisterObjects(void);
 
 public:
   void ExecuteMigrations(void);
@@ -169,6 +172,7 @@ public:
   computeInfo *computeArray;
   patchInfo *patchArray;
   processorInfo *processorArray;
+  LdbProfile *ldbProfile;	// PE 0 only, with ldbProfileFile
 
   LdbInfra *theLbdb;
   LDBarrierClient ldBarrierHandle;
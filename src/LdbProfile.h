@@ -0,0 +1,73 @@
+/**
+***  Copyright (c) 1995, 1996, 1997, 1998, 1999, 2000 by
+***  The Board of Trustees of the University of Illinois.
+***  All rights reserved.
+**/
+
+/*
+   Load profile written at each load balancing step from the object and
+   processor times the centralized load balancer receives.  On PE 0
+   NamdCentLB::buildData() adds every measured object while it fills its
+   own arrays; LdbCoordinator::nodeDone() then adds the patch atom counts
+   summed in its reduction and appends one JSON record per measurement
+   window to ldbProfileFile.
+*/
+
+#ifndef LDBPROFILE_H
+#define LDBPROFILE_H
+
+#include "NamdTypes.h"
+#include "ResizeArray.h"
+
+class ofstream_namd;
+
+enum {
+  LDBPROF_NONBONDED_SELF,
+  LDBPROF_NONBONDED_PAIR,
+  LDBPROF_BONDED,
+  LDBPROF_OTHER_COMPUTE,  // other NAMD computes, e.g. LCPO
+  LDBPROF_PATCH,          // integration and migration in home patches
+  LDBPROF_ARRAY,          // chare arrays, mostly PME pencils
+  LDBPROF_BACKGROUND,     // untimed work: PME and GlobalMaster groups,
+                          // CUDA offload, messaging
+  LDBPROF_IDLE,
+  LDBPROF_NUM_CATEGORIES
+};
+
+class LdbProfile {
+public:
+  LdbProfile(const char *filename, int numBins, int numSlowest);
+  ~LdbProfile();
+
+  // on PE 0, from NamdCentLB::buildData()
+  void begin(int numPes, int numPatches);
+  void addProcessor(int pe, double background, double idle);
+  void addPatch(int pe, PatchID pid, double load);
+  void addCompute(int pe, ComputeID cid, double load);
+  void addObject(int pe, int category, double load);
+
+  // from LdbCoordinator::nodeDone(), with atom counts indexed by patch
+  int pending() const { return isPending; }
+  void write(int step, int numSteps, const int *patchAtoms);
+
+private:
+  int numBins;
+  int numSlowest;
+  int isPending;
+  int numPes;
+  int numPatches;
+  double *peLoad;        // numPes x LDBPROF_NUM_CATEGORIES
+  double *patchLoad;     // with compute loads shared among their patches
+  int *patchPe;
+  ResizeArray<double> computeLoads;
+  double total[LDBPROF_NUM_CATEGORIES];
+  int count[LDBPROF_NUM_CATEGORIES];
+  double maxLoad[LDBPROF_NUM_CATEGORIES];
+  char *filename;
+  ofstream_namd *file;
+
+  void writeHistogram(const char *name, const double *loads, int n);
+};
+
+#endif // LDBPROFILE_H
+
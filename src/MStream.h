@@ -104,11 +104,18 @@ class MOStream {
     unsigned int bufLen;
     StreamMessage *msgBuf;
     Communicate *cobj;
+    int compress;
+    StreamMessage *zipBuf;  // compressed copy of msgBuf when compress is set
+    size_t rawBytes, sentBytes;
     MOStream *Put(char *buf, size_t len); // put len bytes from buf into message
+    void send(void);
   public:
-    MOStream(Communicate *c, int pe, int tag, size_t bufSize);
+    MOStream(Communicate *c, int pe, int tag, size_t bufSize, int compress=0);
     ~MOStream();
     void end(void);
+    // payload bytes put into the stream and bytes actually sent for them
+    size_t bytesPut(void) const { return rawBytes; }
+    size_t bytesSent(void) const { return sentBytes; }
     MOStream *put(char data) { 
       return Put(&data,sizeof(char)); 
     }
@@ -11,6 +11,11 @@
    neighbor even if null so that the HomePatch knows
    what atoms it will have before commencing a positionsReady()
    to its Computes.
+
+   Atoms for all patches on a destination PE travel together in one
+   MigrateAtomsCombinedMsg.  On arrival each destination patch is given
+   a MigrateAtomsMsg referring to its slice of the combined message, so
+   atoms are copied only once, into the patch's atom list.
 */
 
 #ifndef MIGRATEATOMSMSG_H
@@ -23,22 +28,23 @@
 #include "Migration.h"
 #include "PatchMgr.decl.h"
 
-// Message which stores list of atoms and their data
-// which are to be migrated from one patch to another.
-// This message does not contain information that will change asynchronously
-// It does not need to be prepacked
-class MigrateAtomsMsg : public CMessage_MigrateAtomsMsg {
+class MigrateAtomsCombinedMsg;
+
+// Atoms migrating from one patch to another.  This is not a Charm++
+// message; instances are drawn from a per-PE pool in PatchMgr and point
+// into the combined message that carried the atoms, which is freed
+// when the last of its slices is released.
+class MigrateAtomsMsg {
 public:
   NodeID  fromNodeID;
   PatchID srcPatchID;
   PatchID destPatchID;
-  MigrationList migrationList;
+  MigrationElem *migrationList;
+  int numAtoms;
+  MigrateAtomsCombinedMsg *combined;
 
-  MigrateAtomsMsg(void) { ; }
-
-  // pack and unpack functions
-  static void* pack(MigrateAtomsMsg* msg);
-  static MigrateAtomsMsg* unpack(void *ptr);
+  // return to the pool once the atoms have been deposited
+  void release(void);
 };
 
 class MigrateAtomsCombinedMsg : public CMessage_MigrateAtomsCombinedMsg
@@ -50,6 +56,7 @@ public:
   ResizeArray<int> numAtoms;
   int totalAtoms;
   MigrationList migrationList;
+  int pendingSlices;  // not packed, set by distribute()
 
   MigrateAtomsCombinedMsg(void);
   ~MigrateAtomsCombinedMsg(void) { };
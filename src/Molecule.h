@@ -186,6 +186,12 @@ typedef struct rotdrag_params
    Vector p;            //  Rotation pivot point
 } RotDragParams;
 
+typedef struct analysis_rmsd_params
+{
+  Position refPos;      //  Reference position
+  Real weight;          //  Weight in the RMSD
+} AnalysisRMSDParams;
+
 typedef struct constorque_params
 {
    Real v;              //  "Torque" value (Kcal/(mol*A^2))
@@ -325,6 +331,11 @@ private:
   int32 *rotDragIndexes;  //  Rotating drag indexes for each atom
   RotDragParams *rotDragParams;
                                 //  Parameters for each atom rotation-dragged
+  int32 *analysisRMSDIndexes;  //  In-situ RMSD indexes for each atom
+  AnalysisRMSDParams *analysisRMSDParams;
+                                //  Parameters for each atom in the RMSD
+  unsigned char *analysisRDFGroups;  //  In-situ RDF sets of each atom,
+                                //  1 for set A, 2 for set B, 3 for both
 
   Real *langevinParams;   //  b values for langevin dynamics
   int32 *fixedAtomFlags;  //  1 for fixed, -1 for fixed group, else 0
@@ -437,6 +448,8 @@ private:
   // analyze the atoms, and determine which are oxygen, hb donors, etc.
   // this is called after a molecule is sent our (or received in)
   void build_atom_status(void);
+  // move mass from heavy atoms onto their hydrogens (hmassRepart)
+  void repartition_hydrogen_masses(void);
 
 #else
   //the method to load the signatures of atoms etc. (i.e. reading the file in 
@@ -593,6 +606,8 @@ public:
   int numConsTorque;  //  Number of atoms "constant"-torqued
   int numFixedAtoms;  //  Number of fixed atoms
   int numStirredAtoms;  //  Number of stirred atoms
+  int numAnalysisRMSDAtoms;  //  Number of atoms in the in-situ RMSD
+  int numAnalysisRDFAtoms;  //  Number of atoms in the in-situ RDF sets
   int numExPressureAtoms; //  Number of atoms excluded from pressure
   int numHydrogenGroups;  //  Number of hydrogen groups
   int maxHydrogenGroupSize;  //  Max atoms per hydrogen group
@@ -648,12 +663,10 @@ public:
   PDB *goPDB;             //  Pointer to PDB object to use
   // NAMD-Go2 calculation code
   int goNumLJPair;        //  Integer storing the total number of explicit pairs (LJ)
-  int *goIndxLJA;         //  Pointer to the array of atom indices for LJ atom A
-  int *goIndxLJB;         //  Pointer to the array of atom indices for LJ atom B
+  int *goIndxLJB;         //  Partner atom of each native contact, sorted within each atom
   double *goSigmaPairA;  //  Pointer to the array of A LJ parameters
   double *goSigmaPairB;  //  Pointer to the array of B LJ parameters
-  int *pointerToGoBeg;    //  Array of pointers to array
-  int *pointerToGoEnd;    //  Array of pointers to array
+  int *pointerToGoBeg;    //  First contact of each atom; numAtoms+1 entries
   // Gromacs LJ Pair list calculation code
   int numPair;            //  Integer storing the total number of explicit pairs (LJ + Gaussian)
   int numLJPair;          //  Integer storing the number of explicit LJ pairs
@@ -940,6 +953,12 @@ public:
   void build_stirred_atoms(StringList *, StringList *, PDB *, char *);
         //  Determine which atoms are stirred (if any)
 
+  void build_analysis_rmsd_atoms(StringList *, StringList *, PDB *, char *);
+        //  Reference positions and weights for the in-situ RMSD
+
+  void build_analysis_rdf_atoms(StringList *, StringList *, PDB *, char *);
+        //  Atom sets of the in-situ RDF
+
   void build_extra_bonds(Parameters *parameters, StringList *file);
 
 //fepb
@@ -1313,6 +1332,22 @@ public:
   {
     return stirParams[stirIndexes[atomnum]].startTheta;
   }
+
+  //  Get the in-situ RMSD parameters for a specific atom, if it has them
+  Bool get_analysis_rmsd_params(Position &refPos, Real &weight, int atomnum) const
+  {
+    if ( ! numAnalysisRMSDAtoms || analysisRMSDIndexes[atomnum] == -1 ) return FALSE;
+    const AnalysisRMSDParams &p = analysisRMSDParams[analysisRMSDIndexes[atomnum]];
+    refPos = p.refPos;
+    weight = p.weight;
+    return TRUE;
+  }
+
+  //  Get the in-situ RDF sets of a specific atom, 0 if it is in neither
+  int get_analysis_rdf_groups(int atomnum) const
+  {
+    return ( numAnalysisRDFAtoms ? analysisRDFGroups[atomnum] : 0 );
+  }
  
 
   //  Get the moving drag factor for a specific atom
@@ -89,6 +89,9 @@ public:
   static void messageRun();
   void run();                  
 
+  // Rebuild the patch grid in phases from ScriptTcl::redecompose()
+  void redecompose(int phase, int scriptSeq);
+
   // Change parameters in mid-run
   void enableScriptBarrier();  
   void scriptBarrier(void);
@@ -20,6 +20,7 @@ class FloatVector;
 class Lattice;
 class ReplicaDcdInitMsg;
 class ReplicaDcdDataMsg;
+class RestartCheckpoint;
 
 // semaphore "steps", must be negative
 #define FILE_OUTPUT -1
@@ -58,6 +59,8 @@ friend class SimParameters;
    void output_restart_coordinates(Vector *, int, int);
 						//  output coords to 
 						//  restart file
+   void output_restart_dcdfile(int);		//  split dcd file at
+						//  restart
    void output_restart_velocities(int, int, Vector *);
 						//  output velocities to 
 						//  restart file
@@ -78,6 +81,8 @@ friend class SimParameters;
    int replicaDcdActive;
    int replicaDcdIndex;
 
+   RestartCheckpoint *checkpoint;		//  restartCheckpoint writer
+
 public :
    Output();					//  Constructor
    ~Output();					//  Destructor
@@ -97,6 +102,9 @@ public :
 						//  output for the current 
 						//  timestep
 
+  RestartCheckpoint *restartCheckpoint();	//  created on first use
+  void waitRestartCheckpoint();			//  finish pending writes
+
   void replicaDcdOff() { replicaDcdActive = 0; }
   void setReplicaDcdIndex(int index);
   void replicaDcdInit(int index, const char *filename);
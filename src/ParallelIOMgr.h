@@ -67,6 +67,16 @@ class HydroBasedMsg : public CMessage_HydroBasedMsg
 public:
     int numFixedRigidBonds;
     int numFixedGroups;
+    //hydrogen mass repartitioning done on this input proc
+    int numHmassHydrogens;
+    int numHmassWaterSkipped;
+    int numHmassParents;
+    BigReal hmassParentSum;
+    BigReal hmassLightest;
+    //momentum added by rescaling velocities, and on the way back
+    //the total mass to remove it as a center of mass velocity
+    Vector hmassMomentum;
+    BigReal totalMass;
 };
 
 class MoveInputAtomsMsg : public CMessage_MoveInputAtomsMsg
@@ -193,6 +203,13 @@ private:
     //tmp variables
     int procsReceived; //used at updateMolInfo and recvAtomsCntPerPatch
     int hydroMsgRecved; //used at recvHydroBasedCounter
+    //hydrogen mass repartitioning totals, used at recvHydroBasedCounter
+    int numHmassHydrogens;
+    int numHmassWaterSkipped;
+    int numHmassParents;
+    BigReal hmassParentSum;
+    BigReal hmassLightest;
+    Vector hmassMomentum;
     Vector totalMV; //used to remove center of mass motion
     BigReal totalMass; //used to remove center of mass motion
     BigReal totalCharge;
@@ -359,6 +376,7 @@ public:
     void migrateAtomsMGrp();
     void recvAtomsMGrp(MoveInputAtomsMsg *msg);
     void integrateMigratedAtoms();
+    void repartitionHydrogenMasses(HydroBasedMsg *msg);
 
     //Reduce counters for Tuples and Exclusions in Molecule globally
     void updateMolInfo();
@@ -42,6 +42,9 @@ public:
 
   ~PatchMap(void);
 
+  // discard the patch grid before re-decomposition; rank 0 frees shared data
+  void reset(void);
+
   enum { MaxTwoAway = 5*5*5 - 3*3*3 };
   enum { MaxOneAway = 3*3*3 - 1 };
   enum { MaxOneOrTwoAway = MaxOneAway + MaxTwoAway };
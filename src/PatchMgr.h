@@ -74,6 +74,8 @@ public:
   int pid;
   int replica;
   int pe;
+  double rawBytes;     // of the stored checkpoint, in acknowledgements
+  double storedBytes;
   char *key;
 };
 
@@ -160,6 +162,10 @@ public:
   void sendAtoms(PatchID pid, FullAtomList &a);
   void recvAtoms(MovePatchesMsg *msg);
 
+  // patch re-decomposition within a run, see Node::redecompose()
+  void sendRedecomposeAtoms();
+  void recvRedecomposeAtoms(MovePatchesMsg *msg);
+
   // void ackMovePatches(AckMovePatchesMsg *msg);
 
   HomePatch *homePatch(PatchID pid) {
@@ -168,9 +174,18 @@ public:
 
   // void sendMigrationMsg(PatchID, MigrationInfo);
   void sendMigrationMsgs(PatchID, MigrationInfo*, int);
-  // void recvMigrateAtoms(MigrateAtomsMsg *);
   void recvMigrateAtomsCombined(MigrateAtomsCombinedMsg *);
 
+  // per-patch slices of combined migration messages, reused across steps
+  MigrateAtomsMsg *allocMigrateAtomsMsg() {
+    int n = migrateAtomsMsgPool.size();
+    if ( ! n ) return new MigrateAtomsMsg;
+    MigrateAtomsMsg *m = migrateAtomsMsgPool[n-1];
+    migrateAtomsMsgPool.resize(n-1);
+    return m;
+  }
+  void freeMigrateAtomsMsg(MigrateAtomsMsg *m) { migrateAtomsMsgPool.add(m); }
+
   void moveAtom(MoveAtomMsg *msg);
   void moveAllBy(MoveAllByMsg *msg);
   void setLattice(SetLatticeMsg *msg);
@@ -181,8 +196,11 @@ public:
   void recvCheckpointLoad(CheckpointAtomsMsg *msg);
   void sendCheckpointStore(CheckpointAtomsMsg *msg, int dst, int dstpe);
   void recvCheckpointStore(CheckpointAtomsMsg *msg);
-  void sendCheckpointAck(int pid, int dst, int dstpe);
+  void sendCheckpointAck(int pid, int dst, int dstpe,
+                         double rawBytes = 0., double storedBytes = 0.);
   void recvCheckpointAck(CheckpointAtomsReqMsg *msg);
+  void reportCheckpointMemory(int replica, int n, char *key);
+  void recvCheckpointMemory(CkReductionMsg *msg);
 
   void sendExchangeReq(int pid, int src);
   void recvExchangeReq(ExchangeAtomsReqMsg *msg);
@@ -191,6 +209,7 @@ public:
 
 private:
   friend class PatchMap;
+  friend class WorkDistrib;
   PatchMap *patchMap;
 
   int numAllPatches;
@@ -204,9 +223,19 @@ private:
   int recvExchangeReq_index;
   int recvExchangeMsg_index;
 
+  // size of the checkpoints stored for this processor's patches by the
+  // last checkpointStore or checkpointSwap, from the acknowledgements
+  double checkpointRawBytes;
+  double checkpointStoredBytes;
+  int checkpointReportReplica;
+  std::string checkpointReportKey;
+
   // an array of patch pointers residing on this node
   HomePatchList homePatches;
 
+  // atoms of all patches gathered on PE 0 for re-decomposition
+  FullAtomList redecomposeAtoms;
+
   // an array of patches to move off this node
   MovePatchList move;
   int ackMovePending;
@@ -215,6 +244,7 @@ private:
   MigrateAtomsCombinedMsg ** combineMigrationMsgs;
   ResizeArray<int> combineMigrationDestPes;
   int migrationCountdown;
+  ResizeArray<MigrateAtomsMsg*> migrateAtomsMsgPool;
 
 public:
   void setHomePatchFixedAtomNum(int patchId, int numFixed){
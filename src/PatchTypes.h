@@ -25,6 +25,7 @@ public:
   // BEGIN LA
   int doLoweAndersen;
   // END LA
+  int doAnalysis;		// in-situ analysis sample at this step
   int doGBIS;// gbis
   int doLCPO;//LCPO
   int submitLoadStats;
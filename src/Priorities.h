@@ -75,6 +75,8 @@
 //use in Compute::patchReady              DONE
 #define COMPUTE_HOME_PRIORITY (15<<8)
 //end gbis
+// controller consuming reductions it does not yet need, after all else
+#define CONTROLLER_LAG_PRIORITY 0x7fffffff
 
 #endif // PRIORITIES_H
 
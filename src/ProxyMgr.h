@@ -322,6 +322,7 @@ public:
   void removeProxies(void);
   void removeUnusedProxies(void);
   void createProxies(void);
+  void clearSpanningTrees(void);
 
   void createProxy(PatchID pid);
   void removeProxy(PatchID pid);
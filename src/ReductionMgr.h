@@ -155,6 +155,9 @@ typedef enum
   REDUCTION_MARGIN_VIOLATIONS,
   REDUCTION_PAIRLIST_WARNINGS,
   REDUCTION_STRAY_CHARGE_ERRORS,
+  REDUCTION_PATCH_ATOMS_SQUARED,
+  REDUCTION_MIGRATION_ATOMS,
+  REDUCTION_MIGRATION_TIME,
  // semaphore (must be last)
   REDUCTION_MAX_RESERVED
 } ReductionTag;
@@ -178,6 +181,8 @@ enum {
   REDUCTIONS_USER1,
   REDUCTIONS_USER2,
   REDUCTIONS_MULTIGRATOR,
+  REDUCTIONS_LBFGS,  // L-BFGS minimizer dot products
+  REDUCTIONS_ANALYSIS,  // in-situ analysis partial sums
  // semaphore (must be last)
   REDUCTION_MAX_SET_ID
 };
@@ -223,6 +228,7 @@ public:
   int threadIsWaiting;  // is there a thread waiting on this?
   int waitingForSequenceNumber;  // sequence number waited for
   CthThread waitingThread;
+  int waitingLags;  // waiting thread may be awakened at low priority
   ReductionSet(int setID, int size,int numChildren);
   ~ReductionSet();
   int *addToRemoteSequenceNumber;
@@ -269,7 +275,7 @@ private:
   void submit(SubmitReduction*);
   void remove(SubmitReduction*);
 
-  void require(RequireReduction*);
+  void require(RequireReduction*, int maxLag);
   void remove(RequireReduction*);
 
 public:
@@ -338,8 +344,11 @@ private:
   RequireReduction(void) { currentData = 0; data = 0; }
 public:
   BigReal item(int i) const { return data[i]; }
-  void require(void) {
-    master->require(this);
+  // With maxLag nonzero the caller does not need the data urgently: it
+  // runs only when the PE has nothing else to do, unless it has fallen
+  // more than maxLag sequence numbers behind the submitters.
+  void require(int maxLag = 0) {
+    master->require(this, maxLag);
   }
   ~RequireReduction(void) { delete currentData; master->remove(this); }
 };
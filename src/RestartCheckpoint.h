@@ -0,0 +1,103 @@
+/**
+***  Copyright (c) 1995, 1996, 1997, 1998, 1999, 2000 by
+***  The Board of Trustees of the University of Illinois.
+***  All rights reserved.
+**/
+
+/*
+   Restart checkpoint files, which hold the coordinates, velocities and
+   extended system of one restart step in a single file.  The file starts
+   with a header page indexing the blocks, each with its own CRC32; the
+   blocks follow at offsets fixed by the atom count, so each can be
+   written as soon as it arrives.  Blocks are written by a background
+   thread and the header is written and synced last, so a file without a
+   valid header was not completed.
+*/
+
+#ifndef RESTARTCHECKPOINT_H
+#define RESTARTCHECKPOINT_H
+
+#include "common.h"
+#include <string>
+#include <deque>
+
+#if ! defined(WIN32) || defined(__CYGWIN__)
+#define CHECKPOINT_WRITE_THREAD
+#include <pthread.h>
+#endif
+
+class Vector;
+
+class RestartCheckpoint {
+public:
+  enum BlockType {
+    COORDINATES = 0,
+    VELOCITIES = 1,
+    EXTENDED_SYSTEM = 2,
+    NUM_BLOCK_TYPES = 3
+  };
+
+  RestartCheckpoint(int numAtoms);
+  ~RestartCheckpoint();
+
+  // Copies the block and queues it for writing to the checkpoint for
+  // step, which is started on its first block and completed once it
+  // has all block types.
+  void addBlock(int step, int type, const void *data, size_t len);
+
+  // Waits until all blocks added so far have been written.
+  void wait();
+
+  // Read a block of a completed checkpoint file, verifying checksums.
+  static void readVectors(const char *fname, int type, Vector *vecs, int n);
+  static std::string readText(const char *fname, int type);
+
+private:
+  struct IndexEntry {
+    int32 type;
+    unsigned int crc;
+    int64 offset;
+    int64 length;
+  };
+  struct File {
+    char *name;
+    int fd;
+    int step;
+    int added;     // block types queued, main thread only
+    int written;   // block types written, writer only
+    int error;     // errno of the first failed write, writer only
+    IndexEntry index[NUM_BLOCK_TYPES];
+  };
+  struct Job {
+    File *file;
+    int type;
+    char *data;
+    size_t len;
+  };
+
+  int numAtoms;
+  std::deque<File*> openFiles;  // main thread only
+  std::deque<Job> jobs;         // guarded by queueLock
+  std::deque<File*> doneFiles;  // guarded by queueLock
+
+  File *startFile(int step);
+  void writeJob(Job &job);
+  void finishFile(File *f);
+  void reportDone();
+
+  static int64 blockOffset(int type, int numAtoms);
+
+#ifdef CHECKPOINT_WRITE_THREAD
+  int useThread;
+  int stopThread;
+  int busy;
+  pthread_t writeThread;
+  pthread_mutex_t queueLock;  // guards the queues and flags
+  pthread_cond_t queueCond;   // signaled when jobs are queued
+  pthread_cond_t idleCond;    // signaled when the queue has drained
+  static void *write_thread(void *arg);
+#endif
+};
+
+#endif // RESTARTCHECKPOINT_H
+
@@ -51,6 +51,8 @@ private:
   void runController(int task);
   void setParameter(const char* param, const char* value);
   void setParameter(const char* param, int value);
+  void redecompose(int step);
+  void redecomposeExit(int step);
   friend class DataExchanger;
   int eval(const char *script, const char **resultPtr);
 #ifdef NAMD_TCL
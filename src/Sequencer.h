@@ -14,6 +14,7 @@
 class HomePatch;
 class SimParameters;
 class SubmitReduction;
+class InSituAnalysis;
 class CollectionMgr;
 class ControllerBroadcasts;
 class LdbCoordinator;
@@ -23,7 +24,7 @@ class Sequencer
 {
     friend class HomePatch;
 public:
-    Sequencer(HomePatch *p);
+    Sequencer(HomePatch *p, int scriptSeq = 0);
     virtual ~Sequencer(void);
     void run(void);             // spawn thread, etc.
     void awaken(void) {
@@ -49,6 +50,7 @@ protected:
     void submitHalfstep(int);
     void submitMinimizeReductions(int, BigReal fmax2);
     void submitCollections(int step, int zeroVel = 0);
+    void submitAnalysis(int step);
 
     void submitMomentum(int step);
     void correctMomentum(int step, BigReal drifttime);
@@ -65,6 +67,14 @@ protected:
 
     void minimizeMoveDownhill(BigReal fmax2);
     void newMinimizeDirection(BigReal);
+    void newMinimizeDirectionLBFGS(BigReal, int &minSeq);
+    void constrainMinimizeDirection();
+      SubmitReduction *lbfgs_reduction;
+      int lbfgsHistory;      // number of stored correction pairs
+      int lbfgsFirst;        // slot of the oldest pair
+      int lbfgsValid;        // cleared when atoms migrate
+      ResizeArray<Vector> lbfgsS, lbfgsY;  // minLBFGSHistory slots each
+      ResizeArray<Vector> lbfgsLastPosition, lbfgsLastForce;
     void newMinimizePosition(BigReal);
     void quenchVelocities();
 
@@ -122,6 +132,7 @@ protected:
     // End of Multigrator
     
     void cycleBarrier(int,int);
+    int redecompose(int);
 	void traceBarrier(int);
 #ifdef MEASURE_NAMD_WITH_PAPI
 	void papiMeasureBarrier(int);
@@ -133,6 +144,8 @@ protected:
     HomePatch *const patch;		// access methods in patch
     SubmitReduction *reduction;
     SubmitReduction *pressureProfileReduction;
+    InSituAnalysis *analysis;
+    SubmitReduction *analysisReduction;
 
     CollectionMgr *const collection;
     ControllerBroadcasts * broadcast;
@@ -144,6 +157,7 @@ protected:
 private:
     CthThread thread;
     unsigned int priority;
+    int firstScriptSeq;  // script barrier step when created
     static void threadRun(Sequencer*);
 
     LdbCoordinator *ldbCoordinator;
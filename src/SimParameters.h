@@ -17,6 +17,7 @@
 #include "common.h"
 #include "Vector.h"
 #include "Lattice.h"
+#include <iosfwd>
 
 #include "MGridforceParams.h"
 
@@ -72,6 +73,12 @@ typedef int  MTSChoices;
 #define SPLIT_PATCH_POSITION	0	// atom position determines patch
 #define SPLIT_PATCH_HYDROGEN	1	// hydrogen groups are not broken up
 
+// The following definitions are used to distinguish how the in-situ
+// RMSD analysis superimposes the atoms on their reference positions
+#define ANALYSIS_FIT_NONE		0
+#define ANALYSIS_FIT_TRANSLATION	1
+#define ANALYSIS_FIT_ROTATION		2
+
 // The following definitions are used to distinguish the range of rigid
 // bond calculations: none, all bonds to hydrogen, or only water
 #define RIGID_NONE    0
@@ -147,6 +154,10 @@ public:
 	BigReal ldbPMEBackgroundScaling;//  scaling factor for PME background
 	BigReal ldbHomeBackgroundScaling;//  scaling factor for home background
 	BigReal ldbRelativeGrainsize;   //  fraction of average load per compute
+	Bool ldbProfileOn;		//  write load profile at ldb steps?
+	char ldbProfileFile[128];	//  load profile output file
+	int ldbProfileBins;		//  histogram bins in load profile
+	int ldbProfileSlowest;		//  slowest PEs and patches listed
 	
 	int traceStartStep; //the timestep when trace is turned on, default to 3*firstLdbStep;
 	int numTraceSteps; //the number of timesteps that are traced, default to 2*ldbPeriod;
@@ -163,6 +174,8 @@ public:
 	int simulatedNodeSize;
 	Bool disableTopology; // ignore torus information during patch placement
 	Bool verboseTopology; // print torus information during patch placement
+	Bool graphPatchMap; // partition patch graph over physical nodes for placement
+	int controllerLag;  // steps the controller may trail the sequencers
 
 	Bool benchTimestep; //only cares about benchmarking the timestep, so no file output to save SUs for large-scale benchmarking
 
@@ -183,6 +196,9 @@ public:
 	Bool noPatchesOnZero;		//  no patches on processor 0
 	Bool noPatchesOnOutputPEs;	//  no patches on output PEs
 	Bool noPatchesOnOne;		//  no patches on processor 1
+	Bool hashedAtomMap;		//  hash home/proxy atoms instead of
+					//  a table of all atoms on each PE
+	Bool sortPatchAtoms;		//  order atoms in space after migration
 	
 	BigReal initialTemp;   		//  Initial temperature for the 
 					//  simulation
@@ -213,6 +229,21 @@ public:
 	char velDcdFilename[128];       //  Velocity DCD filename
 	char forceDcdFilename[128];     //  Force DCD filename
 	char xstFilename[128];		//  Extended system trajectory filename
+	int analysisFrequency;		//  How often (in timesteps) are the
+					//  in-situ analyses sampled
+	int analysisOutputFrequency;	//  How often (in timesteps) are their
+					//  averages written
+	char analysisFilename[128];	//  Prefix of analysis output files
+	Bool analysisDensityProfileOn;	//  mass, charge and number density
+					//  profile along a cell vector
+	char analysisProfileAxis;	//  'x', 'y', or 'z' for a, b, or c
+	int analysisProfileSlabs;	//  Number of profile slabs
+	Bool analysisRMSDOn;		//  RMSD from reference positions
+	int analysisRMSDFit;		//  ANALYSIS_FIT_NONE, _TRANSLATION,
+					//  or _ROTATION
+	Bool analysisRDFOn;		//  radial distribution function
+					//  between two atom sets
+	int analysisRDFBins;		//  Number of RDF bins up to cutoff
 	char outputFilename[128];	//  Output file name.  This name will
 					//  have .coor appended to it 
 					//  for the coordinates and 
@@ -223,8 +254,16 @@ public:
 					//  restart files be updated
         Bool restartSave;		//  unique filenames for restart files
         Bool restartSaveDcd;		//  unique filenames for DCD files
+	Bool redecomposeOn;		//  rebuild the patch grid at a restart
+					//  point when it needs re-decomposition
+	int redecomposeMarginViolations;	//  margin violations between
+					//  restart points that trigger it
+	BigReal redecomposeImbalance;	//  RMS/mean patch atom count
+					//  that triggers it
 	Bool binaryRestart;		//  should restart files be
 					//  binary format rather than PDB
+	Bool restartCheckpoint;		//  write restart files as one
+					//  checkpoint file per restart
 	Bool binaryOutput;		//  should output files be
 					//  binary format rather than PDB
 	BigReal cutoff;			//  Cutoff distance
@@ -477,6 +516,7 @@ public:
         Bool qmSecProcOn;
         char qmPrepProc[256];
         Bool qmPrepProcOn;
+        Bool qmPersistentOn;
         int qmFormat ;
         Bool qmReplaceAll ;
         Bool qmMOPACAddConfigChrg;
@@ -556,6 +596,9 @@ public:
 	Bool tclBCOn;			//  Are Tcl boundary forces present
 	char *tclBCScript;		//  Script defining tclBC calcforces
 	char tclBCArgs[128];		//  Extra args for calcforces command
+	Bool leptonBCOn;		//  Are Lepton boundary forces present
+	char *leptonBCEnergy;		//  Per-atom boundary energy expression
+	int leptonBCWrapMode;		//  Coordinates seen by the expression
 	Bool freeEnergyOn;		//  Doing free energy perturbation?
 	Bool miscForcesOn;		//  Using misc forces?
 	Bool colvarsOn;         //  Using the colvars module?
@@ -829,6 +872,8 @@ public:
 	BigReal minTinyStep;		//  Minimization parameter
 	BigReal minBabyStep;		//  Minimization parameter
 	BigReal minLineGoal;		//  Minimization parameter
+	Bool minimizeLBFGSOn;		//  Flag TRUE-> L-BFGS search directions
+	int minLBFGSHistory;		//  Number of L-BFGS correction pairs
 	Bool minimizeOn;		//  Flag TRUE-> minimization active
 	BigReal maximumMove;		//  Maximum movement per timestep 
 					//  during minimization
@@ -925,6 +970,10 @@ public:
 
 	Bool useSettle;			// Use SETTLE; requires rigid waters
 
+	Bool hmassRepartOn;		// repartition mass onto hydrogens
+	BigReal hmassRepartMass;	// target hydrogen mass
+	Bool hmassRepartWater;		// also repartition water
+
 	Bool testOn;			//  Do tests rather than simulation
 	Bool commOnly;			//  Don't do any force evaluations
 	Bool statsOn;			//  Don't do any force evaluations
@@ -949,6 +998,8 @@ public:
 	Bool outputPatchDetails;	// print number of atoms per patch
         Bool staticAtomAssignment;      // never migrate atoms
         Bool replicaUniformPatchGrids;  // same patch grid size on all replicas
+        Bool checkpointCompress;        // compress stored checkpoint atoms
+        Bool checkpointDelta;           // delta-encode stored checkpoints
 
 	//
         // hydrogen bond simulation parameters
@@ -984,6 +1035,8 @@ public:
  	int IMDignore;  // IMD connection does not influence simulation
                         // only sends coordinates and energies to VMD
  	int IMDignoreForces;  // Only the Forces are ignored. Finish, Pause and Resume are enabled
+ 	int IMDsendThread;  // send to clients from a background thread
+ 	char IMDsubsetFile[128];  // PDB flagging the atoms to send
                 	
         
         // AMBER options
@@ -1083,6 +1136,7 @@ public:
         int issetinparseopts(const char* name);
 
        	void readExtendedSystem(const char *filename, Lattice *latptr=0);
+       	void readExtendedSystem(std::istream &xscFile, Lattice *latptr=0);
 private:
         ParseOptions *parseopts;
 
@@ -98,6 +98,7 @@ public:
   FullAtomList *createAtomLists(const char *basename=0);
   void createHomePatches(void);
   void distributeHomePatches(void);
+  void redecomposeHomePatches(void);
 
   void reinitAtoms(const char *basename=0);
   void patchMapInit(void);
@@ -156,6 +157,7 @@ private:
   void assignPatchesRoundRobin(void);
   void assignPatchesSpaceFillingCurve(void);
   void assignPatchesBitReversal(void);
+  void assignPatchesGraphPartition(void);
   int  assignPatchesTopoGridRecBisection();
 
   void sortNodesAndAssign(int *assignedNode, int baseNodes = 0);
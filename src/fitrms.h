@@ -2,4 +2,5 @@
 #include "common.h"
 
 BigReal MatrixFitRMS(int n, BigReal *v1, BigReal *v2, const BigReal *wt, BigReal *ttt);
+BigReal MomentFitRMS(BigReal sumwt, BigReal sumsq, BigReal aa[3][3]);
 
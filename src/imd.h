@@ -48,6 +48,15 @@ extern int   imd_send_mdcomm(void *, int32, const int32 *, const float *);
 extern int   imd_send_energies(void *, const IMDEnergies *);
 extern int   imd_send_fcoords(void *, int32, const float *);
 
+// Pack data messages into a buffer of imd_*_size() bytes so that they can
+// be sent later, possibly to several clients, with imd_send_packed().
+// imd_pack_fcoords() returns where the 3*n coordinates are to be stored.
+extern int32 imd_energies_size(void);
+extern void  imd_pack_energies(char *, const IMDEnergies *);
+extern int32 imd_fcoords_size(int32);
+extern float *imd_pack_fcoords(char *, int32);
+extern int   imd_send_packed(void *, const char *, int32);
+
 /// Receive header and data 
 
 // recv_handshake returns 0 if server and client have the same relative 
@@ -1,4 +1,3 @@
-
 #include "largefiles.h"  /* must be first! */
 
 #include "vmdplugin.h"
@@ -20,14 +19,296 @@ static int register_cb(void *v, vmdplugin_t *p) {
 }
 
 #include <sys/types.h>
+#include <sys/stat.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <errno.h>
+#include <math.h>
+#ifdef WIN32
+#include <io.h>
+#else
+#include <fcntl.h>
+#include <unistd.h>
+#include <pthread.h>
+#endif
 
-int main(int argc, char **argv) {
+#ifndef M_PI_2
+#define M_PI_2 1.57079632679489661922
+#endif
+
+#define LINE_MAX 10000
+
+/*
+ * Trajectories are sorted in two passes.  The history files are read
+ * first, writing the sorted history and colvars files and recording for
+ * every input frame which output file and output frame it goes to.
+ * The frames are then copied by one thread per input trajectory, each
+ * reading its input sequentially and writing whole frames directly at
+ * their final offsets in the output files, so no thread waits on another.
+ *
+ * Output trajectories are created by the dcd plugin (header only) and
+ * the frames are written here in the same CHARMM format with unit cell,
+ * which allows them to be extended in place by a later -append run.
+ */
+
+#define DCD_HEADER_SIZE 276  /* as written by the dcd plugin */
+#define DCD_NFILE_POS 8
+#define DCD_NSTEP_POS 20
 
+static long long int dcd_frame_size(int natoms) {
+  return 56 + 3 * (8 + 4 * (long long int) natoms);
+}
+
+static void make_filename(char *filename, const char *output_root, int i) {
+  if ( strstr(output_root,"%s") ) {
+    char istr[10];
+    sprintf(istr,"%d",i);
+    sprintf(filename,output_root,istr);
+  } else {
+    sprintf(filename,output_root,i);
+  }
+}
+
+/*
+ * Copy the colvars trajectory of one replica up to and including step.
+ * With out NULL the lines are consumed without being written, which is
+ * used to skip runs already sorted by a previous invocation.
+ */
+static void copy_colvars(FILE *in, FILE *out, long long int step,
+                         int first_run, int replica) {
+  long long int oldcstep = -1;
+  while ( 1 ) {
+    long long int cstep;
+    char cline[LINE_MAX];
+    char *r;
+    int rc;
+#ifdef WIN32
+    __int64 oldpos = _ftelli64(in);
+#else
+    off_t oldpos = ftello(in);
+#endif
+    r = fgets(cline, LINE_MAX, in);
+    if ( ! r ) { break; }
+    if ( cline[0] == '#' ) {
+      if ( out ) fprintf(out,"%s",cline);
+      continue;
+    }
+    rc = sscanf(cline, "%lld", &cstep);
+    if ( rc != 1 ) {
+      fprintf(stderr,"Format error in colvar trajectory for replica %d: %s",
+							replica, cline);
+      exit(-1);
+    }
+    if ( cstep == oldcstep ) continue;  /* filter out repeats */
+    if ( cstep < oldcstep ) {
+      fprintf(stderr,"Step out of order in colvar trajectory for replica %d: %s",
+							replica, cline);
+      exit(-1);
+    }
+    if ( cstep > step ) {
+#ifdef WIN32
+      _fseeki64(in, oldpos, SEEK_SET);
+#else
+      fseeko(in, oldpos, SEEK_SET);
+#endif
+      break;
+    }
+    if ( out && ( ! first_run || oldcstep != -1 ) ) {  /* skip first entry */
+      fprintf(out,"%s",cline);
+    }
+    oldcstep = cstep;
+  }
+}
+
+static int count_lines(const char *filename) {
+  char line[LINE_MAX];
+  int count = 0;
+  FILE *f = fopen(filename,"r");
+  if ( ! f ) return -1;
+  while ( fgets(line, LINE_MAX, f) ) ++count;
+  fclose(f);
+  return count;
+}
+
+/* number of frames in a sorted trajectory written by this program */
+static int dcd_output_frames(const char *filename, int natoms) {
+  FILE *f;
+  int head[3];
+  long long int size;
+  f = fopen(filename,"rb");
+  if ( ! f ) {
+    fprintf(stderr, "error opening output file %s: %s\n",
+					filename, strerror(errno));
+    exit(-1);
+  }
+  if ( fread(head, sizeof(int), 3, f) != 3 || head[0] != 84 ||
+       strncmp((char*)(head+1),"CORD",4) ) {
+    fprintf(stderr, "%s is not a trajectory written by sortreplicas\n", filename);
+    exit(-1);
+  }
+#ifdef WIN32
+  _fseeki64(f, 0, SEEK_END);
+  size = _ftelli64(f);
+#else
+  fseeko(f, 0, SEEK_END);
+  size = ftello(f);
+#endif
+  fclose(f);
+  if ( size != DCD_HEADER_SIZE + head[2] * dcd_frame_size(natoms) ) {
+    fprintf(stderr, "unexpected size of output file %s, "
+                    "rerun without -append\n", filename);
+    exit(-1);
+  }
+  return head[2];
+}
+
+#ifdef WIN32
+typedef FILE * outfile_t;
+#else
+typedef int outfile_t;
+#endif
+
+static int write_at(outfile_t f, long long int offset, const void *buf, size_t len) {
+#ifdef WIN32
+  if ( _fseeki64(f, offset, SEEK_SET) ) return -1;
+  return ( fwrite(buf, 1, len, f) == len ) ? 0 : -1;
+#else
+  const char *p = (const char *) buf;
+  while ( len ) {
+    ssize_t rc = pwrite(f, p, len, (off_t) offset);
+    if ( rc < 0 ) {
+      if ( errno == EINTR ) continue;
+      return -1;
+    }
+    p += rc;  offset += rc;  len -= rc;
+  }
+  return 0;
+#endif
+}
+
+typedef struct {
+  molfile_plugin_t *plugin;
+  const char *output_root;
+  int num_replicas;
+  int natoms;
+  int first_frame;   /* frames already sorted by a previous run */
+  int num_frames;    /* frames to copy from each input */
+  int *frame_dest;   /* output replica and frame, [frame][input][2] */
+  outfile_t *traj_out;
+  int next_input;    /* work counter, protected by lock */
+  int error;
+#ifndef WIN32
+  pthread_mutex_t lock;
+#endif
+} sort_work_t;
+
+static int next_input(sort_work_t *w) {
+  int i;
+#ifndef WIN32
+  pthread_mutex_lock(&w->lock);
+#endif
+  i = w->error ? w->num_replicas : w->next_input++;
+#ifndef WIN32
+  pthread_mutex_unlock(&w->lock);
+#endif
+  return i;
+}
+
+static void set_error(sort_work_t *w) {
+#ifndef WIN32
+  pthread_mutex_lock(&w->lock);
+#endif
+  w->error = 1;
+#ifndef WIN32
+  pthread_mutex_unlock(&w->lock);
+#endif
+}
+
+static void *copy_frames(void *arg) {
+  sort_work_t *w = (sort_work_t *) arg;
+  const int natoms = w->natoms;
+  const long long int frame_size = dcd_frame_size(natoms);
   molfile_timestep_t frame;
+  char *filename;
+  char *buf;
+  int i;
+
+  filename = (char*) malloc(strlen(w->output_root)+100);
+  buf = (char*) malloc(frame_size);
+  frame.coords = (float*) malloc(3*natoms*sizeof(float));
+  frame.velocities = (float*) NULL;
+
+  while ( (i = next_input(w)) < w->num_replicas ) {
+    void *traj_in;
+    int rc, j, k, n;
+    make_filename(filename, w->output_root, i);
+    sprintf(filename + strlen(filename),".%d.dcd",i);
+    n = natoms;
+    traj_in = w->plugin->open_file_read(filename,"dcd",&n);
+    if ( ! traj_in || n != natoms ) {
+      fprintf(stderr, "error opening input file %s: %s\n",
+					filename, strerror(errno));
+      set_error(w);
+      break;
+    }
+    for ( j=0; j<w->first_frame; ++j ) {
+      rc = w->plugin->read_next_timestep(traj_in,natoms,NULL);
+      if ( rc != MOLFILE_SUCCESS ) break;
+    }
+    for ( j=0; j<w->num_frames; ++j ) {
+      const int *dest = w->frame_dest + 2*(j*w->num_replicas + i);
+      double unitcell[6];
+      int reclen;
+      char *p;
+      rc = w->plugin->read_next_timestep(traj_in,natoms,&frame);
+      if ( rc != MOLFILE_SUCCESS ) {
+        fprintf(stderr,"Unable to read frame %d for replica %d\n",
+						w->first_frame+j, i);
+        set_error(w);
+        break;
+      }
+      /* same record layout as the dcd plugin's write_timestep */
+      unitcell[0] = frame.A;
+      unitcell[2] = frame.B;
+      unitcell[5] = frame.C;
+      unitcell[1] = sin((M_PI_2 / 90.0) * (90.0 - frame.gamma)); /* cosAB */
+      unitcell[3] = sin((M_PI_2 / 90.0) * (90.0 - frame.beta));  /* cosAC */
+      unitcell[4] = sin((M_PI_2 / 90.0) * (90.0 - frame.alpha)); /* cosBC */
+      p = buf;
+      reclen = 48;
+      memcpy(p, &reclen, 4);  p += 4;
+      memcpy(p, unitcell, 48);  p += 48;
+      memcpy(p, &reclen, 4);  p += 4;
+      reclen = 4*natoms;
+      for ( k=0; k<3; ++k ) {
+        float *x;
+        int a;
+        memcpy(p, &reclen, 4);  p += 4;
+        x = (float *) p;
+        for ( a=0; a<natoms; ++a ) x[a] = frame.coords[3*a+k];
+        p += reclen;
+        memcpy(p, &reclen, 4);  p += 4;
+      }
+      if ( write_at(w->traj_out[dest[0]],
+              DCD_HEADER_SIZE + dest[1] * frame_size, buf, frame_size) ) {
+        fprintf(stderr, "error writing output trajectory %d: %s\n",
+						dest[0], strerror(errno));
+        set_error(w);
+        break;
+      }
+    }
+    w->plugin->close_file_read(traj_in);
+  }
+
+  free(frame.coords);
+  free(buf);
+  free(filename);
+  return NULL;
+}
+
+int main(int argc, char **argv) {
+
   molfile_plugin_t *plugin;
   char *output_root;
   char *filename;
@@ -36,20 +317,38 @@ int main(int argc, char **argv) {
   long long int final_step = -1;
   long long int checkstep = -1;
   int colvars;
+  int append = 0;
+  int num_threads = 0;
+  int runs_done = 0;
+  int frames_done = 0;
+  int num_frames, max_frames;
+  int *frame_dest;
+  int *in_frames;
+  int *out_frames;
   FILE **hist_in;
   FILE **hist_out;
   FILE **colv_in;
   FILE **colv_out;
-  void **traj_in;
-  void **traj_out;
+  outfile_t *traj_out;
+  sort_work_t work;
   int natoms=MOLFILE_NUMATOMS_UNKNOWN;
   int i, i_run;
 
   molfile_dcdplugin_init();
   molfile_dcdplugin_register(&plugin, register_cb);
 
+  while ( argc > 1 && argv[1][0] == '-' ) {
+    if ( ! strcmp(argv[1],"-append") ) {
+      append = 1;
+    } else if ( ! strcmp(argv[1],"-threads") && argc > 2 ) {
+      num_threads = atoi(argv[2]);
+      ++argv;  --argc;
+    } else break;
+    ++argv;  --argc;
+  }
+
   if ( argc < 4 || argc > 5 ) {
-    fprintf(stderr, "args: <job_output_root> <num_replicas> <runs_per_frame> [final_step]\n");
+    fprintf(stderr, "args: [-threads <n>] [-append] <job_output_root> <num_replicas> <runs_per_frame> [final_step]\n");
     exit(-1);
   }
   output_root = argv[1];
@@ -58,24 +357,24 @@ int main(int argc, char **argv) {
   if ( argc > 4 ) {
     sscanf(argv[4], "%lld", &final_step);
   }
+  if ( num_replicas < 1 || runs_per_frame < 1 ) {
+    fprintf(stderr, "num_replicas and runs_per_frame must be positive\n");
+    exit(-1);
+  }
 
   filename = (char*) malloc(strlen(output_root)+100);
   hist_in = (FILE**) malloc(num_replicas*sizeof(FILE*));
   hist_out = (FILE**) malloc(num_replicas*sizeof(FILE*));
   colv_in = (FILE**) malloc(num_replicas*sizeof(FILE*));
   colv_out = (FILE**) malloc(num_replicas*sizeof(FILE*));
-  traj_in = (void**) malloc(num_replicas*sizeof(FILE*));
-  traj_out = (void**) malloc(num_replicas*sizeof(FILE*));
+  traj_out = (outfile_t*) malloc(num_replicas*sizeof(outfile_t));
+  in_frames = (int*) malloc(num_replicas*sizeof(int));
+  out_frames = (int*) malloc(num_replicas*sizeof(int));
 
   for ( i=0; i<num_replicas; ++i ) {
     char *root_end;
-    if ( strstr(output_root,"%s") ) {
-      char istr[10];
-      sprintf(istr,"%d",i);
-      sprintf(filename,output_root,istr);
-    } else {
-      sprintf(filename,output_root,i);
-    }
+    void *traj_in;
+    make_filename(filename, output_root, i);
     root_end = filename + strlen(filename);
 
     sprintf(root_end,".%d.history",i);
@@ -86,12 +385,18 @@ int main(int argc, char **argv) {
       exit(-1);
     }
     sprintf(root_end,".%d.dcd",i);
-    traj_in[i] = plugin->open_file_read(filename,"dcd",&natoms);
-    if ( ! traj_in[i] ) {
+    traj_in = plugin->open_file_read(filename,"dcd",&natoms);
+    if ( ! traj_in ) {
       fprintf(stderr, "error opening input file %s: %s\n",
 					filename, strerror(errno));
       exit(-1);
     }
+    /* count frames now, they are copied later by the worker threads */
+    in_frames[i] = 0;
+    while ( plugin->read_next_timestep(traj_in,natoms,NULL) == MOLFILE_SUCCESS ) {
+      ++in_frames[i];
+    }
+    plugin->close_file_read(traj_in);
     sprintf(root_end,".%d.colvars.traj",i);
     colv_in[i] = fopen(filename,"r");
     if ( colv_in[i] ) {
@@ -113,34 +418,91 @@ int main(int argc, char **argv) {
     }
   }
 
+  if ( append ) {
+    /* every run adds one line to each sorted history file */
+    for ( i=0; i<num_replicas; ++i ) {
+      int lines;
+      make_filename(filename, output_root, i);
+      sprintf(filename + strlen(filename),".%d.sort.history",i);
+      lines = count_lines(filename);
+      if ( i == 0 && lines < 0 ) {
+        printf("No sorted output found, sorting from the beginning.\n");
+        append = 0;
+        break;
+      }
+      if ( i == 0 ) runs_done = lines;
+      else if ( lines != runs_done ) {
+        fprintf(stderr, "sorted history files have different lengths, "
+                        "rerun without -append\n");
+        exit(-1);
+      }
+    }
+  }
+
+  if ( append ) {
+    char line[LINE_MAX];
+    frames_done = runs_done / runs_per_frame;
+    for ( i_run=0; i_run<runs_done; ++i_run ) {
+      for ( i=0; i<num_replicas; ++i ) {
+        long long int step;
+        if ( ! fgets(line, LINE_MAX, hist_in[i]) ||
+             sscanf(line, "%lld", &step) != 1 ) {
+          fprintf(stderr, "history for replica %d is shorter than the sorted "
+                          "output, rerun without -append\n", i);
+          exit(-1);
+        }
+        if ( i == 0 ) checkstep = step;
+        if ( colvars ) copy_colvars(colv_in[i], NULL, step, i_run == 0, i);
+      }
+    }
+    printf("Appending to %d runs already sorted.\n", runs_done);
+  }
+
   for ( i=0; i<num_replicas; ++i ) {
     char *root_end;
-    if ( strstr(output_root,"%s") ) {
-      char istr[10];
-      sprintf(istr,"%d",i);
-      sprintf(filename,output_root,istr);
-    } else {
-      sprintf(filename,output_root,i);
-    }
+    make_filename(filename, output_root, i);
     root_end = filename + strlen(filename);
 
     sprintf(root_end,".%d.sort.history",i);
-    hist_out[i] = fopen(filename,"w");
+    hist_out[i] = fopen(filename, append ? "a" : "w");
     if ( ! hist_out[i] ) {
       fprintf(stderr, "error opening output file %s: %s\n",
 					filename, strerror(errno));
       exit(-1);
     }
     sprintf(root_end,".%d.sort.dcd",i);
-    traj_out[i] = plugin->open_file_write(filename,"dcd",natoms);
+    if ( append ) {
+      out_frames[i] = dcd_output_frames(filename, natoms);
+      if ( out_frames[i] != frames_done ) {
+        fprintf(stderr, "output file %s has %d frames, expected %d; "
+                "rerun without -append\n", filename, out_frames[i], frames_done);
+        exit(-1);
+      }
+    } else {
+      /* let the plugin write the header */
+      void *traj = plugin->open_file_write(filename,"dcd",natoms);
+      if ( ! traj ) {
+        fprintf(stderr, "error opening output file %s: %s\n",
+					filename, strerror(errno));
+        exit(-1);
+      }
+      plugin->close_file_write(traj);
+      out_frames[i] = 0;
+    }
+#ifdef WIN32
+    traj_out[i] = fopen(filename,"r+b");
     if ( ! traj_out[i] ) {
+#else
+    traj_out[i] = open(filename,O_RDWR);
+    if ( traj_out[i] < 0 ) {
+#endif
       fprintf(stderr, "error opening output file %s: %s\n",
 					filename, strerror(errno));
       exit(-1);
     }
     if ( colvars ) {
       sprintf(root_end,".%d.sort.colvars.traj",i);
-      colv_out[i] = fopen(filename,"w");
+      colv_out[i] = fopen(filename, append ? "a" : "w");
       if ( ! colv_out[i] ) {
         fprintf(stderr, "error opening output file %s: %s\n",
 					filename, strerror(errno));
@@ -149,14 +511,19 @@ int main(int argc, char **argv) {
     }
   }
 
-  frame.coords = (float*) malloc(3*natoms*sizeof(float));
-  frame.velocities = (float*) NULL;
-
-#define LINE_MAX 10000
+  num_frames = 0;
+  max_frames = 16;
+  frame_dest = (int*) malloc(2*max_frames*num_replicas*sizeof(int));
 
-  i_run = 0;
+  i_run = runs_done;
   for ( ; 1; ++i_run ) { /* loop until read fails */
     char line[LINE_MAX];
+    const int has_frame = ! ( (i_run+1) % runs_per_frame );
+    if ( has_frame && num_frames == max_frames ) {
+      max_frames *= 2;
+      frame_dest = (int*) realloc(frame_dest,
+                                  2*max_frames*num_replicas*sizeof(int));
+    }
     for ( i=0; i<num_replicas; ++i ) {
       char *r;
       char sav;
@@ -183,6 +550,19 @@ int main(int argc, char **argv) {
           printf("Stopping after final step %lld.\n", final_step);
           break;
         }
+        if ( has_frame ) {
+          /* stop before any output if a replica lacks the frame */
+          const int k = (i_run+1) / runs_per_frame - 1;
+          int j;
+          for ( j=0; j<num_replicas; ++j ) {
+            if ( k >= in_frames[j] ) break;
+          }
+          if ( j < num_replicas ) {
+            fprintf(stderr,"Unable to read frame for replica %d at line %d: %s",
+							j, i_run, line);
+            break;
+          }
+        }
       } else if ( step != checkstep ) {
         fprintf(stderr,"Step mismatch for replica %d at line %d: %s",
 							i, i_run, line);
@@ -197,57 +577,10 @@ int main(int argc, char **argv) {
       line[f1] = 0;
       fprintf(hist_out[rep_id],"%s%d%s",line,i,line+f2);
       line[f1] = sav;
-      if ( colvars ) {
-       long long int oldcstep = -1;
-       while ( 1 ) {
-        long long int cstep;
-        char cline[LINE_MAX];
-#ifdef WIN32
-        __int64 oldpos = _ftelli64(colv_in[i]);
-#else
-        off_t oldpos = ftello(colv_in[i]);
-#endif
-        r = fgets(cline, LINE_MAX, colv_in[i]);
-        if ( ! r ) { break; }
-        if ( cline[0] == '#' ) {
-          fprintf(colv_out[rep_id],"%s",cline);
-          continue;
-        } 
-        rc = sscanf(cline, "%lld", &cstep);
-        if ( rc != 1 ) {
-          fprintf(stderr,"Format error in colvar trajectory for replica %d: %s",
-							i, cline);
-          exit(-1);
-        }
-        if ( cstep == oldcstep ) continue;  /* filter out repeats */
-        if ( cstep < oldcstep ) {
-          fprintf(stderr,"Step out of order in colvar trajectory for replica %d: %s",
-							i, cline);
-          exit(-1);
-        }
-        if ( cstep > step ) {
-#ifdef WIN32
-          _fseeki64(colv_in[i], oldpos, SEEK_SET);
-#else
-          fseeko(colv_in[i], oldpos, SEEK_SET);
-#endif
-          break;
-        }
-        if ( i_run != 0 || oldcstep != -1 ) {  /* skip first entry */
-          fprintf(colv_out[rep_id],"%s",cline);
-        }
-        oldcstep = cstep;
-       }
-      }
-      if ( (i_run+1) % runs_per_frame ) continue;
-      rc = plugin->read_next_timestep(traj_in[i],natoms,&frame);
-      if ( rc == MOLFILE_SUCCESS ) {
-        plugin->write_timestep(traj_out[rep_id],&frame);
-      } else {
-        fprintf(stderr,"Unable to read frame for replica %d at line %d: %s",
-							i, i_run, line);
-        break;
-      }
+      if ( colvars ) copy_colvars(colv_in[i], colv_out[rep_id], step, i_run == 0, i);
+      if ( ! has_frame ) continue;
+      frame_dest[2*(num_frames*num_replicas + i)] = rep_id;
+      frame_dest[2*(num_frames*num_replicas + i) + 1] = out_frames[rep_id]++;
     }
     if ( i < num_replicas ) {
       printf("Processed %d runs.\n",i_run);
@@ -255,19 +588,76 @@ int main(int argc, char **argv) {
 							i, i_run, line);
       break;
     }
+    if ( has_frame ) ++num_frames;
   }
 
-  free(frame.coords);
+  /* copy the frames recorded above */
+  work.plugin = plugin;
+  work.output_root = output_root;
+  work.num_replicas = num_replicas;
+  work.natoms = natoms;
+  work.first_frame = frames_done;
+  work.num_frames = num_frames;
+  work.frame_dest = frame_dest;
+  work.traj_out = traj_out;
+  work.next_input = 0;
+  work.error = 0;
+  if ( num_frames ) {
+#ifdef WIN32
+    /* positioned writes through shared FILE handles are not thread-safe */
+    copy_frames(&work);
+#else
+    pthread_t *threads;
+    if ( num_threads < 1 ) num_threads = (int) sysconf(_SC_NPROCESSORS_ONLN);
+    if ( num_threads > num_replicas ) num_threads = num_replicas;
+    if ( num_threads < 1 ) num_threads = 1;
+    printf("Copying %d frames from each replica using %d threads.\n",
+						num_frames, num_threads);
+    fflush(stdout);
+    pthread_mutex_init(&work.lock, NULL);
+    threads = (pthread_t*) malloc(num_threads*sizeof(pthread_t));
+    for ( i=1; i<num_threads; ++i ) {
+      if ( pthread_create(&threads[i], NULL, copy_frames, &work) ) {
+        fprintf(stderr, "unable to create thread, continuing with %d\n", i);
+        num_threads = i;
+        break;
+      }
+    }
+    copy_frames(&work);
+    for ( i=1; i<num_threads; ++i ) pthread_join(threads[i], NULL);
+    free(threads);
+    pthread_mutex_destroy(&work.lock);
+#endif
+  }
+
+  if ( work.error ) {
+    fprintf(stderr, "Sorted trajectories are incomplete, rerun without -append.\n");
+  } else for ( i=0; i<num_replicas; ++i ) {
+    /* frame and step count in the header, as the dcd plugin would */
+    if ( write_at(traj_out[i], DCD_NFILE_POS, &out_frames[i], sizeof(int)) ||
+         write_at(traj_out[i], DCD_NSTEP_POS, &out_frames[i], sizeof(int)) ) {
+      fprintf(stderr, "error writing output trajectory %d: %s\n", i, strerror(errno));
+    }
+  }
+
+  free(frame_dest);
+  free(in_frames);
+  free(out_frames);
 
   for ( i=0; i<num_replicas; ++i ) {
     if ( fclose(hist_in[i]) ) {
       fprintf(stderr, "error closing history input file %d: %s\n", i, strerror(errno));
     }
-    plugin->close_file_read(traj_in[i]);
     if ( fclose(hist_out[i]) ) {
       fprintf(stderr, "error closing history output file %d: %s\n", i, strerror(errno));
     }
-    plugin->close_file_write(traj_out[i]);
+#ifdef WIN32
+    if ( fclose(traj_out[i]) ) {
+#else
+    if ( close(traj_out[i]) ) {
+#endif
+      fprintf(stderr, "error closing trajectory output file %d: %s\n", i, strerror(errno));
+    }
     if ( colvars ) {
       if ( fclose(colv_in[i]) ) {
         fprintf(stderr, "error closing colvars input file %d: %s\n", i, strerror(errno));
@@ -279,6 +669,6 @@ int main(int argc, char **argv) {
   }
 
   molfile_dcdplugin_fini();
+  if ( work.error ) exit(-1);
   exit(0);
 }
-
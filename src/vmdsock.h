@@ -33,5 +33,6 @@ int   vmdsock_write(void *, const void *, int);
 int   vmdsock_read(void *, void *, int);
 int   vmdsock_selread(void *, int);
 int   vmdsock_selwrite(void *, int);
+void  vmdsock_shutdown(void *);  /* wake up a blocked read or write */
 void  vmdsock_destroy(void *);
 